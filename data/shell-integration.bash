@@ -0,0 +1,20 @@
+# qmshell shell integration, passed to bash with --rcfile.
+# Loads the user's rc file first, then adds the OSC 133 prompt marks so a
+# PS1 assigned in ~/.bashrc doesn't drop them.
+
+[ -f ~/.bashrc ] && . ~/.bashrc
+
+if [[ $PS1 != *'133;A'* ]]; then
+    # Capture $? before any other PROMPT_COMMAND entry overwrites it, and pass it on
+    __qmshell_prompt_status() { __qmshell_status=$?; return $__qmshell_status; }
+
+    if [[ $(declare -p PROMPT_COMMAND 2>/dev/null) == "declare -a"* ]]; then
+        PROMPT_COMMAND=(__qmshell_prompt_status "${PROMPT_COMMAND[@]}")
+    else
+        PROMPT_COMMAND="__qmshell_prompt_status${PROMPT_COMMAND:+; $PROMPT_COMMAND}"
+    fi
+
+    # D;status + A before the prompt, B after it, C (via PS0) before command output
+    PS1='\[\e]133;D;${__qmshell_status}\a\e]133;A\a\]'"$PS1"'\[\e]133;B\a\]'
+    PS0='\e]133;C\a'"$PS0"
+fi
@@ -6,7 +6,7 @@ import qmshell.settings 1.0
 Window {
     id: settingsWindow
     width: 400
-    height: 250
+    height: 330
     title: "Qmterm Settings"
     color: currentTheme.Background || "#1C2126"
     visible: false
@@ -187,6 +187,31 @@ Window {
                     }
                 }
             }
+
+            Text { text: "Restore Session:"; color: settingsWindow.currentTheme.Foreground || "#f2f2f2"; Layout.alignment: Qt.AlignVCenter }
+
+            ThemedCheckBox {
+                id: restoreSessionCheck
+                Layout.columnSpan: 2
+                theme: settingsWindow.currentTheme
+                label: "Keep scrollback between launches"
+                checked: SettingsManager.loadSessionRestoreEnabled()
+                onToggled: SettingsManager.saveSessionRestoreEnabled(checked)
+            }
+
+            Text { text: "Raw Input:"; color: settingsWindow.currentTheme.Foreground || "#f2f2f2"; Layout.alignment: Qt.AlignVCenter }
+
+            ThemedCheckBox {
+                id: rawInputCheck
+                Layout.columnSpan: 2
+                theme: settingsWindow.currentTheme
+                label: "Send every key straight to the shell"
+                checked: SettingsManager.loadRawInputEnabled()
+                onToggled: {
+                    SettingsManager.saveRawInputEnabled(checked)
+                    terminalBackend.rawInputMode = checked
+                }
+            }
         }
     }
 
@@ -21,8 +21,28 @@ Item {
         var promptPos = textArea.promptPosition
     }
 
+    /* ===  Prompt index (OSC 133 marks)  === */
+    readonly property string promptMarker: "<!--qmshell-prompt-->"
+    property var promptPositions: []
+    property int promptJumpIndex: -1
+
+    function resetPromptIndex() {
+        promptPositions = []
+        promptJumpIndex = -1
+    }
+
+    function jumpToPrompt(step) {
+        if (promptPositions.length === 0) return
+        if (promptJumpIndex < 0) promptJumpIndex = promptPositions.length
+        promptJumpIndex = Math.max(0, Math.min(promptPositions.length - 1, promptJumpIndex + step))
+        const rect = textArea.positionToRectangle(promptPositions[promptJumpIndex])
+        const bar = scrollView.ScrollBar.vertical
+        bar.position = Math.max(0, Math.min(1.0 - bar.size, rect.y / textArea.height))
+    }
+
     /* ===  Root-level helpers exported to main.qml  === */
     function appendText(data)        { scrollView.appendText(data) }
+    function setCurrentLine(data, cursorColumn) { scrollView.setCurrentLine(data, cursorColumn) }
     function insertPastedText(text)  { scrollView.insertPastedText(text) }
     function setCommandFromHistory(cmd) {
         var promptPos = textArea.promptPosition
@@ -39,6 +59,10 @@ Item {
     signal sendKeyData(string keyData)
     signal openLinkRequested(string url)
     signal openSettingsRequested()
+    signal saveScrollbackRequested(string fileUrl, string format)
+
+    // Scrollback export progress, driven from main.qml; -1 when idle
+    property real exportProgress: -1
 
     /* ===  Utility functions  === */
     function getHoverColor(baseColor) {
@@ -74,6 +98,9 @@ Item {
         function clearTerminal() {
             textArea.clear()
             textArea.promptPosition = 0
+            textArea.liveLineLength = 0
+            container.resetPromptIndex()
+            terminalBackend.clearScrollback()
             ScrollBar.vertical.position = 0.0
         }
 
@@ -87,18 +114,46 @@ Item {
             textArea.insert(textArea.cursorPosition, text)
         }
 
-        function appendText(data) {
-            const wasAtBottom = scrollView.atYEnd
-
+        function formatOutput(data) {
             // Replace control characters or specific patterns
             let cleaned = data.replace(/\^C/g, '<span style="color:red;">aborted</span>')
 
             // Replace URLs with clickable links
             const urlRegex = /(?:(?:https?|ftp):\/\/|www\.|ftp\.)(?:\([-A-Z0-9+&@#\/%=~_|$?!:,.]*\)|[-A-Z0-9+&@#\/%=~_|$?!:,.])*(?:\([-A-Z0-9+&@#\/%=~_|$?!:,.]*\)|[A-Z0-9+&@#\/%=~_|$])/igm
-            const formatted = cleaned.replace(urlRegex, url =>
+            return cleaned.replace(urlRegex, url =>
                 `<a href="${url}"><font color="${container.currentTheme.Color4}" style="text-decoration:underline">${url}</font></a>`)
+        }
+
+        // Raw input mode: the line under the cursor lives after promptPosition and is replaced whole
+        function removeCurrentLine() {
+            if (textArea.liveLineLength <= 0) return
+            textArea.remove(textArea.promptPosition, textArea.promptPosition + textArea.liveLineLength)
+            textArea.liveLineLength = 0
+        }
+
+        function setCurrentLine(data, cursorColumn) {
+            const wasAtBottom = scrollView.atYEnd
+            const start = textArea.promptPosition
+            removeCurrentLine()
+            if (data.length > 0) textArea.insert(start, formatOutput(data))
+            textArea.liveLineLength = textArea.length - start
+            textArea.cursorPosition = start + Math.min(cursorColumn, textArea.liveLineLength)
+            if (wasAtBottom) Qt.callLater(scrollToBottom)
+        }
 
-            textArea.insert(textArea.length, formatted)
+        function appendText(data) {
+            const wasAtBottom = scrollView.atYEnd
+            // Completed lines replace the edited one; the backend re-sends it afterwards
+            removeCurrentLine()
+            const formatted = formatOutput(data)
+
+            // Backend tags each OSC 133 prompt start; record where it lands in the TextArea
+            const parts = formatted.split(container.promptMarker)
+            for (let i = 0; i < parts.length; ++i) {
+                if (i > 0) container.promptPositions.push(textArea.length)
+                if (parts[i].length > 0) textArea.insert(textArea.length, parts[i])
+            }
+            container.promptJumpIndex = -1
             textArea.promptPosition = textArea.length
             textArea.cursorPosition = textArea.length
 
@@ -109,10 +164,12 @@ Item {
 
         TextArea {
             id: textArea
+            objectName: "terminalInput" // raw input mode targets this item from C++
             height: Math.max(scrollView.availableHeight, implicitHeight)
             textFormat: Text.RichText
             wrapMode: Text.WordWrap
             property int promptPosition: 0
+            property int liveLineLength: 0 // raw input mode: length of the edited line after promptPosition
             property string actualInputText: "" // Stores the real text in password mode
             color: container.currentTheme.Foreground
             background: Rectangle { color: container.currentTheme.Background }
@@ -127,7 +184,11 @@ Item {
 
             cursorDelegate: Rectangle {
                 width: 2; height: textArea.font.pixelSize; color: textArea.color; visible: textArea.activeFocus
+                // Only blink while the window is focused so idle terminals don't keep repainting
+                readonly property bool blinking: visible && Qt.application.state === Qt.ApplicationActive
+                onBlinkingChanged: if (!blinking) opacity = 1
                 SequentialAnimation on opacity {
+                    running: blinking
                     loops: Animation.Infinite
                     NumberAnimation { to: 0; duration: 500 }
                     NumberAnimation { to: 1; duration: 500 }
@@ -157,6 +218,19 @@ Item {
                                     event.accepted = false
                                     return
                                 }
+                                // Ctrl+Shift+C / Ctrl+Shift+V also work in raw input mode, where Ctrl+C goes to the shell
+                                if (event.modifiers === (Qt.ControlModifier | Qt.ShiftModifier)) {
+                                    if (event.key === Qt.Key_C) {
+                                        if (textArea.selectedText.length > 0) container.copyRequested(textArea.selectedText)
+                                        event.accepted = true
+                                        return
+                                    }
+                                    if (event.key === Qt.Key_V) {
+                                        if (!container.passwordModeActive) container.pasteRequested()
+                                        event.accepted = true
+                                        return
+                                    }
+                                }
                                 if (event.matches(StandardKey.Copy)) {
                                     if (textArea.selectedText.length > 0) {
                                         container.copyRequested(textArea.selectedText)
@@ -177,6 +251,14 @@ Item {
                                 }
                                 if (event.matches(StandardKey.SelectAll)) { textArea.select(promptPosition, textArea.length); event.accepted = true; return }
 
+                                // ==== Prompt Navigation ====
+                                if (event.modifiers === (Qt.ControlModifier | Qt.ShiftModifier)
+                                        && (event.key === Qt.Key_Up || event.key === Qt.Key_Down)) {
+                                    container.jumpToPrompt(event.key === Qt.Key_Up ? -1 : 1)
+                                    event.accepted = true
+                                    return
+                                }
+
                                 // ==== History Navigation ====
                                 if (event.key === Qt.Key_Up) {
                                     // Don't allow history navigation in password mode
@@ -372,6 +454,13 @@ Item {
                     Text { anchors.verticalCenter: parent.verticalCenter; anchors.left: parent.left; anchors.leftMargin: 10; text: "Copy"; color: copyMouseArea.containsMouse ? container.getContrastingTextColor(parent.color) : container.currentTheme.Foreground || "#f2f2f2" }
                     MouseArea { id: copyMouseArea; anchors.fill: parent; hoverEnabled: true; onClicked: { container.copyRequested(textArea.selectedText); contextMenu.close() } }
                 }
+                Rectangle {
+                    width: parent.width; height: 30; visible: contextMenu.clickedLink === "" && !container.passwordModeActive
+                    color: copyOutputMouseArea.pressed ? container.getPressedColor(container.currentTheme.Background) : (copyOutputMouseArea.containsMouse ? container.getHoverColor(container.currentTheme.Background) : "transparent")
+                    radius: contextMenu.radius
+                    Text { anchors.verticalCenter: parent.verticalCenter; anchors.left: parent.left; anchors.leftMargin: 10; text: "Copy Last Output"; color: copyOutputMouseArea.containsMouse ? container.getContrastingTextColor(parent.color) : container.currentTheme.Foreground || "#f2f2f2" }
+                    MouseArea { id: copyOutputMouseArea; anchors.fill: parent; hoverEnabled: true; onClicked: { container.copyRequested(terminalBackend.lastCommandOutput()); contextMenu.close() } }
+                }
                 Rectangle { width: parent.width - 10; height: 1; anchors.horizontalCenter: parent.horizontalCenter; color: container.currentTheme.Color0Intense || "#444"; visible: (contextMenu.clickedLink !== "") || (contextMenu.clickedLink === "" && contextMenu.hasSelection) }
                 Rectangle {
                     width: parent.width; height: 30; visible: !container.passwordModeActive
@@ -380,6 +469,20 @@ Item {
                     Text { anchors.verticalCenter: parent.verticalCenter; anchors.left: parent.left; anchors.leftMargin: 10; text: "Paste"; color: pasteMouseArea.containsMouse ? container.getContrastingTextColor(parent.color) : container.currentTheme.Foreground || "#f2f2f2" }
                     MouseArea { id: pasteMouseArea; anchors.fill: parent; hoverEnabled: true; onClicked: { container.pasteRequested(); contextMenu.close() } }
                 }
+                Rectangle {
+                    width: parent.width; height: 30; visible: !container.passwordModeActive
+                    color: saveScrollbackMouseArea.pressed ? container.getPressedColor(container.currentTheme.Background) : (saveScrollbackMouseArea.containsMouse ? container.getHoverColor(container.currentTheme.Background) : "transparent")
+                    radius: contextMenu.radius
+                    Text { anchors.verticalCenter: parent.verticalCenter; anchors.left: parent.left; anchors.leftMargin: 10; text: container.exportProgress >= 0 ? "Cancel Save" : "Save Scrollback..."; color: saveScrollbackMouseArea.containsMouse ? container.getContrastingTextColor(parent.color) : container.currentTheme.Foreground || "#f2f2f2" }
+                    MouseArea {
+                        id: saveScrollbackMouseArea; anchors.fill: parent; hoverEnabled: true
+                        onClicked: {
+                            if (container.exportProgress >= 0) terminalBackend.cancelScrollbackExport()
+                            else saveScrollbackDialog.open()
+                            contextMenu.close()
+                        }
+                    }
+                }
                 Rectangle { width: parent.width - 10; height: 1; anchors.horizontalCenter: parent.horizontalCenter; color: container.currentTheme.Color0Intense || "#444"; visible: true }
                 Rectangle {
                     width: parent.width; height: 30
@@ -399,6 +502,26 @@ Item {
             }
         }
 
+        FileDialog {
+            id: saveScrollbackDialog
+            title: "Save Scrollback"
+            fileMode: FileDialog.SaveFile
+            nameFilters: ["Plain text (*.txt)", "ANSI text (*.ansi)", "HTML (*.html)"]
+            onAccepted: {
+                const formats = ["text", "ansi", "html"]
+                container.saveScrollbackRequested(file.toString(), formats[selectedNameFilter.index] || "text")
+            }
+        }
+
+        // Thin progress bar along the bottom edge while a scrollback export runs
+        Rectangle {
+            anchors.left: parent.left; anchors.bottom: parent.bottom
+            height: 3; z: 5
+            width: parent.width * Math.max(0, container.exportProgress)
+            visible: container.exportProgress >= 0
+            color: container.currentTheme.Color4 || "#87CEFA"
+        }
+
         Popup {
             id: infoPopup
             width: container.width /1.5; height: contentHeight
@@ -0,0 +1,34 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+
+// CheckBox styled from the current terminal theme, used by the settings window.
+CheckBox {
+    id: control
+
+    property var theme: ({})
+    property string label: ""
+
+    indicator: Rectangle {
+        implicitWidth: 18; implicitHeight: 18
+        x: control.leftPadding
+        y: (control.height - height) / 2
+        radius: 4
+        color: control.theme.Background || "#1C2126"
+        border.color: control.hovered ? control.theme.Color4 || "#87CEFA" : control.theme.Color0Intense || "#444"
+        border.width: 1
+
+        Rectangle {
+            width: 10; height: 10; radius: 2
+            anchors.centerIn: parent
+            color: control.theme.Color4 || "#87CEFA"
+            visible: control.checked
+        }
+    }
+
+    contentItem: Text {
+        text: control.label
+        color: control.theme.Foreground || "#f2f2f2"
+        leftPadding: control.indicator.width + control.spacing
+        verticalAlignment: Text.AlignVCenter
+    }
+}
@@ -71,18 +71,32 @@ ApplicationWindow {
 
         function onForceClear() {
             terminalView.textArea.clear();
+            terminalView.textArea.promptPosition = 0;
+            terminalView.textArea.liveLineLength = 0;
+            terminalView.resetPromptIndex();
+            terminalBackend.clearScrollback();
             terminalBackend.sendCommand("");
         }
 
         function onNewData(htmlData) {
             terminalView.appendText(htmlData)
         }
+        function onCurrentLineUpdated(htmlData, cursorColumn) {
+            terminalView.setCurrentLine(htmlData, cursorColumn)
+        }
         function onClipboardTextReady(text) {
             terminalView.insertPastedText(text)
         }
         function onPasswordModeChanged(active) {
             terminalView.passwordModeActive = active;
         }
+        function onScrollbackExportProgress(fraction) {
+            terminalView.exportProgress = fraction;
+        }
+        function onScrollbackExportFinished(ok, message) {
+            terminalView.exportProgress = -1;
+            if (!ok) console.warn("Saving scrollback failed:", message);
+        }
     }
 
     TerminalView {
@@ -97,6 +111,9 @@ ApplicationWindow {
         onSendKeyData: (keyData) => terminalBackend.sendKeyData(keyData)
         onOpenLinkRequested: (url) => terminalBackend.openLink(url)
         onOpenSettingsRequested: root.openSettings()
+        onSaveScrollbackRequested: (fileUrl, format) => {
+            if (terminalBackend.saveScrollback(fileUrl, format)) terminalView.exportProgress = 0;
+        }
     }
 
     Rectangle {
@@ -15,13 +15,27 @@ TARGET = qmshell
 RESOURCES += qmshell.qrc
 
 SOURCES += \
+    src/currentline.cpp \
+    src/keyencoder.cpp \
     src/main.cpp \
+    src/promptindex.cpp \
+    src/scrollbackbuffer.cpp \
+    src/scrollbackexporter.cpp \
+    src/scrollbacksnapshot.cpp \
     src/settingsmanager.cpp \
+    src/sgrstate.cpp \
     src/terminalbackend.cpp \
     src/terminalcolor.cpp
 
 HEADERS += \
+    src/currentline.h \
+    src/keyencoder.h \
+    src/promptindex.h \
+    src/scrollbackbuffer.h \
+    src/scrollbackexporter.h \
+    src/scrollbacksnapshot.h \
     src/settingsmanager.h \
+    src/sgrstate.h \
     src/terminalbackend.h \
     src/terminalcolor.h
 
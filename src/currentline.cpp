@@ -0,0 +1,119 @@
+#include "currentline.h"
+#include "sgrstate.h"
+
+static const int kTabWidth = 8;
+
+void CurrentLine::reset(bool startsReset)
+{
+    m_cells.clear();
+    m_cursor = 0;
+    m_startsReset = startsReset;
+}
+
+void CurrentLine::newLine()
+{
+    // A non-empty line ends with a reset, an empty one leaves the state as it was
+    reset(m_startsReset || !m_cells.isEmpty());
+}
+
+void CurrentLine::put(QChar c, const QString &sgr)
+{
+    while (m_cells.size() < m_cursor) {
+        m_cells.append({ QChar(' '), QString() });
+    }
+    if (m_cursor < m_cells.size()) {
+        m_cells[m_cursor] = { c, sgr };
+    } else {
+        m_cells.append({ c, sgr });
+    }
+    ++m_cursor;
+}
+
+void CurrentLine::backspace()
+{
+    if (m_cursor > 0) {
+        --m_cursor;
+    }
+}
+
+void CurrentLine::tab()
+{
+    m_cursor = (m_cursor / kTabWidth + 1) * kTabWidth;
+}
+
+void CurrentLine::moveTo(int column)
+{
+    m_cursor = qMax(0, column);
+}
+
+void CurrentLine::moveBy(int count)
+{
+    m_cursor = qMax(0, m_cursor + count);
+}
+
+void CurrentLine::erase(int mode)
+{
+    switch (mode) {
+    case 0:
+        if (m_cursor < m_cells.size()) {
+            m_cells.resize(m_cursor);
+        }
+        break;
+    case 1:
+        for (int i = 0; i <= m_cursor && i < m_cells.size(); ++i) {
+            m_cells[i] = { QChar(' '), QString() };
+        }
+        break;
+    case 2:
+        m_cells.clear();
+        break;
+    default:
+        break;
+    }
+}
+
+void CurrentLine::deleteChars(int count)
+{
+    if (m_cursor < m_cells.size()) {
+        m_cells.remove(m_cursor, qMin<qsizetype>(qMax(1, count), m_cells.size() - m_cursor));
+    }
+}
+
+void CurrentLine::eraseChars(int count)
+{
+    for (int i = m_cursor; i < m_cursor + qMax(1, count) && i < m_cells.size(); ++i) {
+        m_cells[i] = { QChar(' '), QString() };
+    }
+}
+
+void CurrentLine::insertBlanks(int count)
+{
+    if (m_cursor < m_cells.size()) {
+        m_cells.insert(m_cursor, qMax(1, count), { QChar(' '), QString() });
+    }
+}
+
+QString CurrentLine::toAnsi() const
+{
+    QString text;
+    for (qsizetype i = 0; i < m_cells.size(); ++i) {
+        const Cell &cell = m_cells.at(i);
+        // Each run restates its attributes from a reset, since the cells before it may have changed
+        const bool newRun = i == 0 ? (!m_startsReset || !cell.sgr.isEmpty())
+                                   : cell.sgr != m_cells.at(i - 1).sgr;
+        if (newRun) {
+            text += QStringLiteral("\x1b[0m") + cell.sgr;
+        }
+        text += cell.ch;
+    }
+    if (!m_cells.isEmpty() && !m_cells.last().sgr.isEmpty()) {
+        text += QStringLiteral("\x1b[0m");
+    }
+    return text;
+}
+
+QString CurrentLine::toHtml(const QMap<QString, QColor> &colorScheme) const
+{
+    SgrState state;
+    return SgrState::renderHtml(toAnsi(), state, colorScheme);
+}
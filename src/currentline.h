@@ -0,0 +1,57 @@
+#ifndef CURRENTLINE_H
+#define CURRENTLINE_H
+
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QColor>
+
+// The line the cursor is on, kept as cells so carriage return, backspace,
+// horizontal cursor moves and erase-in-line can rewrite it the way readline
+// redraws expect. Each cell remembers the SGR sequences in effect when it was
+// printed (everything since the last reset), so a rewritten line renders the
+// same from scratch.
+//
+// Only the current line can be edited: redraws that move the cursor up
+// (wrapped input lines, full-screen apps) are not supported.
+class CurrentLine
+{
+public:
+    // startsReset: the scrollback is in the default SGR state where this line begins
+    void reset(bool startsReset);
+    // Moves on to the next line after the text was committed.
+    void newLine();
+
+    bool isEmpty() const { return m_cells.isEmpty(); }
+    int cursor() const { return m_cursor; }
+
+    void put(QChar c, const QString &sgr);
+    void carriageReturn() { m_cursor = 0; }
+    void backspace();
+    void tab();
+    void moveTo(int column);
+    void moveBy(int count);
+    // CSI K: 0 = cursor to end, 1 = start to cursor, 2 = whole line
+    void erase(int mode);
+    // CSI P, CSI X and CSI @
+    void deleteChars(int count);
+    void eraseChars(int count);
+    void insertBlanks(int count);
+
+    // Text with inline SGR sequences, as stored in the scrollback. Ends in the default state.
+    QString toAnsi() const;
+    QString toHtml(const QMap<QString, QColor> &colorScheme) const;
+
+private:
+    struct Cell
+    {
+        QChar ch;
+        QString sgr;
+    };
+
+    QList<Cell> m_cells;
+    int m_cursor = 0;
+    bool m_startsReset = true;
+};
+
+#endif // CURRENTLINE_H
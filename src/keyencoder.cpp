@@ -0,0 +1,128 @@
+#include "keyencoder.h"
+
+// xterm modifier parameter: 1 + Shift(1) + Alt(2) + Ctrl(4) + Meta(8); 1 means none
+int KeyEncoder::modifierParam(Qt::KeyboardModifiers modifiers)
+{
+    int param = 1;
+    if (modifiers & Qt::ShiftModifier) param += 1;
+    if (modifiers & Qt::AltModifier) param += 2;
+    if (modifiers & Qt::ControlModifier) param += 4;
+    if (modifiers & Qt::MetaModifier) param += 8;
+    return param;
+}
+
+QByteArray KeyEncoder::cursorKey(char final, Qt::KeyboardModifiers modifiers, bool applicationCursorKeys)
+{
+    const int param = modifierParam(modifiers);
+    if (param > 1) {
+        return "\x1b[1;" + QByteArray::number(param) + final;
+    }
+    return QByteArray(applicationCursorKeys ? "\x1bO" : "\x1b[") + final;
+}
+
+QByteArray KeyEncoder::tildeKey(int number, Qt::KeyboardModifiers modifiers)
+{
+    const int param = modifierParam(modifiers);
+    QByteArray seq = "\x1b[" + QByteArray::number(number);
+    if (param > 1) {
+        seq += ';' + QByteArray::number(param);
+    }
+    return seq + '~';
+}
+
+QByteArray KeyEncoder::ss3Key(char final, Qt::KeyboardModifiers modifiers)
+{
+    const int param = modifierParam(modifiers);
+    if (param > 1) {
+        return "\x1b[1;" + QByteArray::number(param) + final;
+    }
+    return QByteArray("\x1bO") + final;
+}
+
+QByteArray KeyEncoder::encode(int key, Qt::KeyboardModifiers modifiers, const QString &text,
+                              bool applicationCursorKeys, bool applicationKeypad)
+{
+    const bool keypad = modifiers.testFlag(Qt::KeypadModifier);
+    modifiers &= ~(Qt::KeypadModifier | Qt::GroupSwitchModifier);
+    const bool ctrl = modifiers.testFlag(Qt::ControlModifier);
+    const bool alt = modifiers.testFlag(Qt::AltModifier);
+    const QByteArray altPrefix = alt ? QByteArray("\x1b") : QByteArray();
+
+    // Keypad in application mode (DECKPAM) sends SS3 sequences
+    if (keypad && applicationKeypad && modifiers == Qt::NoModifier) {
+        if (key >= Qt::Key_0 && key <= Qt::Key_9) return QByteArray("\x1bO") + char('p' + (key - Qt::Key_0));
+        switch (key) {
+        case Qt::Key_Enter:    return "\x1bOM";
+        case Qt::Key_Plus:     return "\x1bOk";
+        case Qt::Key_Minus:    return "\x1bOm";
+        case Qt::Key_Asterisk: return "\x1bOj";
+        case Qt::Key_Slash:    return "\x1bOo";
+        case Qt::Key_Period:   return "\x1bOn";
+        default: break;
+        }
+    }
+
+    switch (key) {
+    case Qt::Key_Shift: case Qt::Key_Control: case Qt::Key_Alt: case Qt::Key_Meta:
+    case Qt::Key_AltGr: case Qt::Key_CapsLock: case Qt::Key_NumLock: case Qt::Key_ScrollLock:
+    case Qt::Key_Super_L: case Qt::Key_Super_R: case Qt::Key_Hyper_L: case Qt::Key_Hyper_R:
+        return QByteArray();
+
+    case Qt::Key_Return:
+    case Qt::Key_Enter:     return altPrefix + '\r';
+    case Qt::Key_Backspace: return altPrefix + (ctrl ? '\x08' : '\x7f');
+    case Qt::Key_Tab:       return altPrefix + '\t';
+    case Qt::Key_Backtab:   return altPrefix + "\x1b[Z";
+    case Qt::Key_Escape:    return altPrefix + '\x1b';
+
+    case Qt::Key_Up:    return cursorKey('A', modifiers, applicationCursorKeys);
+    case Qt::Key_Down:  return cursorKey('B', modifiers, applicationCursorKeys);
+    case Qt::Key_Right: return cursorKey('C', modifiers, applicationCursorKeys);
+    case Qt::Key_Left:  return cursorKey('D', modifiers, applicationCursorKeys);
+    case Qt::Key_Home:  return cursorKey('H', modifiers, applicationCursorKeys);
+    case Qt::Key_End:   return cursorKey('F', modifiers, applicationCursorKeys);
+
+    case Qt::Key_Insert:   return tildeKey(2, modifiers);
+    case Qt::Key_Delete:   return tildeKey(3, modifiers);
+    case Qt::Key_PageUp:   return tildeKey(5, modifiers);
+    case Qt::Key_PageDown: return tildeKey(6, modifiers);
+
+    case Qt::Key_F1:  return ss3Key('P', modifiers);
+    case Qt::Key_F2:  return ss3Key('Q', modifiers);
+    case Qt::Key_F3:  return ss3Key('R', modifiers);
+    case Qt::Key_F4:  return ss3Key('S', modifiers);
+    case Qt::Key_F5:  return tildeKey(15, modifiers);
+    case Qt::Key_F6:  return tildeKey(17, modifiers);
+    case Qt::Key_F7:  return tildeKey(18, modifiers);
+    case Qt::Key_F8:  return tildeKey(19, modifiers);
+    case Qt::Key_F9:  return tildeKey(20, modifiers);
+    case Qt::Key_F10: return tildeKey(21, modifiers);
+    case Qt::Key_F11: return tildeKey(23, modifiers);
+    case Qt::Key_F12: return tildeKey(24, modifiers);
+    default: break;
+    }
+
+    // Ctrl combinations map to C0 control codes
+    if (ctrl) {
+        char code = 0;
+        bool mapped = true;
+        if (key >= Qt::Key_A && key <= Qt::Key_Z) code = char(key - Qt::Key_A + 1);
+        else if (key == Qt::Key_Space || key == Qt::Key_At || key == Qt::Key_2) code = 0x00;
+        else if (key == Qt::Key_BracketLeft || key == Qt::Key_3) code = 0x1b;
+        else if (key == Qt::Key_Backslash || key == Qt::Key_4) code = 0x1c;
+        else if (key == Qt::Key_BracketRight || key == Qt::Key_5) code = 0x1d;
+        else if (key == Qt::Key_AsciiCircum || key == Qt::Key_6) code = 0x1e;
+        else if (key == Qt::Key_Underscore || key == Qt::Key_Minus || key == Qt::Key_7) code = 0x1f;
+        else if (key == Qt::Key_Question || key == Qt::Key_8) code = 0x7f;
+        else mapped = false;
+        if (mapped) {
+            return altPrefix + QByteArray(1, code);
+        }
+    }
+
+    if (text.isEmpty()) {
+        return QByteArray();
+    }
+    // Alt sends ESC before the character (xterm metaSendsEscape)
+    return altPrefix + text.toUtf8();
+}
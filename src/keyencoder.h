@@ -0,0 +1,23 @@
+#ifndef KEYENCODER_H
+#define KEYENCODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <Qt>
+
+// Translates Qt key events into the byte sequences an xterm would send.
+class KeyEncoder
+{
+public:
+    // Returns an empty array for keys that produce no input (bare modifiers etc.).
+    static QByteArray encode(int key, Qt::KeyboardModifiers modifiers, const QString &text,
+                             bool applicationCursorKeys, bool applicationKeypad);
+
+private:
+    static int modifierParam(Qt::KeyboardModifiers modifiers);
+    static QByteArray cursorKey(char final, Qt::KeyboardModifiers modifiers, bool applicationCursorKeys);
+    static QByteArray tildeKey(int number, Qt::KeyboardModifiers modifiers);
+    static QByteArray ss3Key(char final, Qt::KeyboardModifiers modifiers);
+};
+
+#endif // KEYENCODER_H
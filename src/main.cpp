@@ -6,6 +6,7 @@
 #include <QTextStream>
 #include <QStandardPaths>
 #include <QCommandLineParser>
+#include <QQuickWindow>
 #include "terminalbackend.h"
 #include "settingsmanager.h"
 
@@ -55,6 +56,10 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
+    // Stop pushing output to QML while the window is minimized or occluded
+    backend.trackWindow(qobject_cast<QQuickWindow *>(engine.rootObjects().first()));
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &backend, &TerminalBackend::saveSession);
+
     QCoreApplication::setApplicationVersion(baseVersion);
     QCommandLineParser parser;
     parser.setApplicationDescription("qmshell Terminal Emulator");
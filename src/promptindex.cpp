@@ -0,0 +1,63 @@
+#include "promptindex.h"
+
+PromptIndex::PromptIndex(int maxRecords)
+    : m_maxRecords(qMax(1, maxRecords))
+{
+    m_clock.start();
+}
+
+void PromptIndex::markPromptStart(const ScrollbackPosition &pos)
+{
+    CommandRecord record;
+    record.promptStart = pos;
+    m_records.append(record);
+
+    if (m_records.size() > m_maxRecords) {
+        m_records.removeFirst();
+        if (m_lastCommand >= 0) --m_lastCommand;
+    }
+}
+
+void PromptIndex::markCommandStart(const ScrollbackPosition &pos)
+{
+    if (m_records.isEmpty()) return;
+    m_records.last().commandStart = pos;
+}
+
+void PromptIndex::markOutputStart(const ScrollbackPosition &pos)
+{
+    if (m_records.isEmpty()) return;
+    CommandRecord &record = m_records.last();
+    record.outputStart = pos;
+    record.startedAtMs = m_clock.elapsed();
+    record.running = true;
+    m_lastCommand = int(m_records.size()) - 1;
+}
+
+bool PromptIndex::markOutputEnd(const ScrollbackPosition &pos, int exitCode)
+{
+    if (m_records.isEmpty() || !m_records.last().running) return false;
+    CommandRecord &record = m_records.last();
+    record.outputEnd = pos;
+    record.wallTimeMs = m_clock.elapsed() - record.startedAtMs;
+    record.exitCode = exitCode;
+    record.running = false;
+    return true;
+}
+
+void PromptIndex::addOutputBytes(qint64 bytes)
+{
+    if (m_records.isEmpty() || !m_records.last().running) return;
+    m_records.last().outputBytes += bytes;
+}
+
+void PromptIndex::clear()
+{
+    m_records.clear();
+    m_lastCommand = -1;
+}
+
+const CommandRecord *PromptIndex::lastCommand() const
+{
+    return m_lastCommand >= 0 ? &m_records.at(m_lastCommand) : nullptr;
+}
@@ -0,0 +1,48 @@
+#ifndef PROMPTINDEX_H
+#define PROMPTINDEX_H
+
+#include "scrollbackbuffer.h"
+#include <QList>
+#include <QElapsedTimer>
+
+// One prompt/command/output cycle as reported by OSC 133 (FinalTerm) marks:
+// A = prompt start, B = command start, C = output start, D = command finished.
+struct CommandRecord
+{
+    ScrollbackPosition promptStart;
+    ScrollbackPosition commandStart;
+    ScrollbackPosition outputStart;
+    ScrollbackPosition outputEnd;
+    qint64 startedAtMs = 0;
+    qint64 wallTimeMs = -1;
+    qint64 outputBytes = 0;
+    int exitCode = -1;
+    bool running = false;
+};
+
+class PromptIndex
+{
+public:
+    explicit PromptIndex(int maxRecords = 10000);
+
+    void markPromptStart(const ScrollbackPosition &pos);
+    void markCommandStart(const ScrollbackPosition &pos);
+    void markOutputStart(const ScrollbackPosition &pos);
+    // Returns true if this closed a running command.
+    bool markOutputEnd(const ScrollbackPosition &pos, int exitCode);
+    void addOutputBytes(qint64 bytes);
+    void clear();
+
+    int size() const { return int(m_records.size()); }
+    const CommandRecord &at(int index) const { return m_records.at(index); }
+    // Most recent record that produced output, or nullptr.
+    const CommandRecord *lastCommand() const;
+
+private:
+    QList<CommandRecord> m_records;
+    QElapsedTimer m_clock;
+    int m_lastCommand = -1;
+    int m_maxRecords;
+};
+
+#endif // PROMPTINDEX_H
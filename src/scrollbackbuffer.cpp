@@ -0,0 +1,172 @@
+#include "scrollbackbuffer.h"
+#include "scrollbacksnapshot.h"
+
+ScrollbackBuffer::ScrollbackBuffer(qsizetype maxLines, qint64 maxSnapshotLines)
+    : m_maxLines(qMax<qsizetype>(1, maxLines))
+    , m_maxSnapshotLines(qMax<qint64>(0, maxSnapshotLines))
+    , m_lineLimit(m_maxLines)
+{
+}
+
+void ScrollbackBuffer::appendText(const QString &text)
+{
+    QMutexLocker locker(&m_mutex);
+    qsizetype start = 0;
+    while (start <= text.size()) {
+        const qsizetype newline = text.indexOf(QChar('\n'), start);
+        if (newline < 0) {
+            m_currentLine += QStringView(text).mid(start);
+            break;
+        }
+        m_currentLine += QStringView(text).mid(start, newline - start);
+        m_lines.append(m_currentLine);
+        m_currentLine.clear();
+        start = newline + 1;
+    }
+
+    const qint64 excess = snapshotLines() + m_lines.size() - m_lineLimit;
+    if (excess > 0 && m_snapshot) {
+        // Snapshot lines are older than anything in memory, so they go first
+        const qint64 skipped = qMin(excess, snapshotLines());
+        m_snapshotStart += skipped;
+        m_firstLine += skipped;
+        if (snapshotLines() == 0) {
+            m_snapshot.reset();
+            m_snapshotStart = 0;
+        }
+    }
+    while (m_lines.size() > m_lineLimit) {
+        m_lines.removeFirst();
+        ++m_firstLine;
+    }
+}
+
+void ScrollbackBuffer::appendSgr(const QString &params)
+{
+    QMutexLocker locker(&m_mutex);
+    m_currentLine += QStringLiteral("\x1b[") + params + QChar('m');
+}
+
+void ScrollbackBuffer::setCurrentLine(const QString &text)
+{
+    QMutexLocker locker(&m_mutex);
+    m_currentLine = text;
+}
+
+void ScrollbackBuffer::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    // Numbering moves past the discarded partial line as well, so positions
+    // recorded on it become stale instead of pointing into the new first line
+    m_firstLine += snapshotLines() + m_lines.size() + 1;
+    m_snapshot.reset();
+    m_snapshotStart = 0;
+    m_lineLimit = m_maxLines;
+    m_lines.clear();
+    m_currentLine.clear();
+}
+
+void ScrollbackBuffer::attachSnapshot(const QSharedPointer<const ScrollbackSnapshot> &snapshot)
+{
+    QMutexLocker locker(&m_mutex);
+    Q_ASSERT(m_lines.isEmpty() && m_currentLine.isEmpty());
+    m_snapshot = snapshot;
+    // A snapshot saved with a larger limit only contributes its newest lines
+    m_snapshotStart = qMax<qint64>(0, snapshot->lineCount() - m_maxSnapshotLines);
+    m_firstLine += m_snapshotStart;
+    m_lineLimit = qMax<qint64>(m_maxLines, snapshotLines());
+}
+
+qint64 ScrollbackBuffer::snapshotLines() const
+{
+    return m_snapshot ? m_snapshot->lineCount() - m_snapshotStart : 0;
+}
+
+ScrollbackPosition ScrollbackBuffer::position() const
+{
+    return { m_firstLine + snapshotLines() + m_lines.size(), int(m_currentLine.size()) };
+}
+
+QString ScrollbackBuffer::line(qint64 absoluteLine) const
+{
+    qint64 index = absoluteLine - m_firstLine;
+    if (index < 0) {
+        return QString();
+    }
+    if (index < snapshotLines()) {
+        return m_snapshot->line(m_snapshotStart + index);
+    }
+    index -= snapshotLines();
+    if (index > m_lines.size()) {
+        return QString();
+    }
+    return index == m_lines.size() ? m_currentLine : m_lines.at(index);
+}
+
+QByteArray ScrollbackBuffer::utf8Line(qint64 absoluteLine) const
+{
+    const qint64 index = absoluteLine - m_firstLine;
+    if (index >= 0 && index < snapshotLines()) {
+        return m_snapshot->rawLine(m_snapshotStart + index);
+    }
+    return line(absoluteLine).toUtf8();
+}
+
+QStringList ScrollbackBuffer::readLines(qint64 &from, qint64 to, int maxCount) const
+{
+    QMutexLocker locker(&m_mutex);
+    from = qMax(from, m_firstLine);
+    const qint64 end = qMin(qMin(to, endLine()), from + maxCount);
+    QStringList result;
+    for (qint64 n = from; n < end; ++n) {
+        result.append(line(n));
+    }
+    return result;
+}
+
+QString ScrollbackBuffer::text(const ScrollbackPosition &from, const ScrollbackPosition &to, bool keepSgr) const
+{
+    ScrollbackPosition start = from;
+    if (start.line < m_firstLine) {
+        start = { m_firstLine, 0 };
+    }
+    const ScrollbackPosition end = to.isValid() ? to : position();
+    if (end.line < start.line) {
+        return QString();
+    }
+
+    QString result;
+    for (qint64 n = start.line; n <= end.line && n < endLine(); ++n) {
+        const QString current = line(n);
+        const int first = n == start.line ? start.column : 0;
+        const int last = n == end.line ? qMin<int>(end.column, current.size()) : current.size();
+        if (last > first) {
+            result += QStringView(current).mid(first, last - first);
+        }
+        if (n != end.line) {
+            result += QChar('\n');
+        }
+    }
+    return keepSgr ? result : stripSgr(result);
+}
+
+QString ScrollbackBuffer::stripSgr(const QString &text)
+{
+    if (!text.contains(QChar('\x1B'))) {
+        return text;
+    }
+    QString plain;
+    plain.reserve(text.size());
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (text[i] == QChar('\x1B') && i + 1 < text.size() && text[i + 1] == QChar('[')) {
+            qsizetype j = i + 2;
+            while (j < text.size() && text[j] != QChar('m')) {
+                ++j;
+            }
+            i = j;
+            continue;
+        }
+        plain += text[i];
+    }
+    return plain;
+}
@@ -0,0 +1,77 @@
+#ifndef SCROLLBACKBUFFER_H
+#define SCROLLBACKBUFFER_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QMutex>
+
+class ScrollbackSnapshot;
+
+// Absolute position in the scrollback. Line numbers keep counting up after
+// old lines are evicted, so stored positions stay valid (or detectably stale).
+struct ScrollbackPosition
+{
+    qint64 line = -1;
+    int column = 0;
+
+    bool isValid() const { return line >= 0; }
+};
+
+// Line store for everything the PTY has printed. Text is kept with its SGR
+// sequences inline ("\x1b[...m") so attributes survive; other control
+// sequences are dropped by the parser before they get here.
+//
+// A restored snapshot can sit in front of the in-memory lines. Its lines are
+// decoded from the mapping on access. Up to maxSnapshotLines of them are kept,
+// and the line limit grows to match so the restored history isn't evicted
+// straight away; eviction then skips past snapshot lines before it touches
+// the in-memory ones.
+class ScrollbackBuffer
+{
+public:
+    explicit ScrollbackBuffer(qsizetype maxLines = 100000, qint64 maxSnapshotLines = 1000000);
+
+    void appendText(const QString &text);
+    void appendSgr(const QString &params);
+    // Replaces the unfinished last line, for output that rewrites it in place.
+    void setCurrentLine(const QString &text);
+    void clear();
+    // Only valid on an empty buffer; the snapshot lines become the oldest history.
+    void attachSnapshot(const QSharedPointer<const ScrollbackSnapshot> &snapshot);
+
+    ScrollbackPosition position() const;
+    qint64 firstLine() const { return m_firstLine; }
+    qint64 endLine() const { return m_firstLine + snapshotLines() + m_lines.size() + 1; }
+    QString line(qint64 absoluteLine) const;
+    QByteArray utf8Line(qint64 absoluteLine) const;
+
+    // Safe to call from another thread: copies up to maxCount lines starting at
+    // from, which is moved forward if those lines were evicted meanwhile.
+    QStringList readLines(qint64 &from, qint64 to, int maxCount) const;
+
+    // Text between two positions; SGR sequences are stripped unless keepSgr is set.
+    QString text(const ScrollbackPosition &from, const ScrollbackPosition &to, bool keepSgr = false) const;
+
+    static QString stripSgr(const QString &text);
+
+private:
+    qint64 snapshotLines() const;
+
+    // Guards mutation against readLines() from export threads; GUI-thread reads need no lock
+    mutable QMutex m_mutex;
+    QSharedPointer<const ScrollbackSnapshot> m_snapshot;
+    // Snapshot lines before this index have been evicted
+    qint64 m_snapshotStart = 0;
+    QList<QString> m_lines;
+    QString m_currentLine;
+    qint64 m_firstLine = 0;
+    qsizetype m_maxLines;
+    qint64 m_maxSnapshotLines;
+    // m_maxLines, or the restored snapshot's size if that is larger
+    qint64 m_lineLimit;
+};
+
+#endif // SCROLLBACKBUFFER_H
@@ -0,0 +1,97 @@
+#include "scrollbackexporter.h"
+#include "scrollbackbuffer.h"
+#include "sgrstate.h"
+#include <QSaveFile>
+#include <QStringList>
+
+// Lines copied out of the buffer per step; bounds memory and lock hold time.
+static const int kExportBlockLines = 1024;
+
+ScrollbackExporter::ScrollbackExporter(const ScrollbackBuffer &buffer, qint64 firstLine, qint64 endLine,
+                                       const QString &path, Format format,
+                                       const QMap<QString, QColor> &colorScheme)
+    : m_buffer(buffer)
+    , m_firstLine(firstLine)
+    , m_endLine(endLine)
+    , m_path(path)
+    , m_format(format)
+    , m_colorScheme(colorScheme)
+    , m_cancelled(0)
+{
+}
+
+void ScrollbackExporter::cancel()
+{
+    m_cancelled.storeRelaxed(1);
+}
+
+bool ScrollbackExporter::formatFromName(const QString &name, Format *format)
+{
+    const QString key = name.toLower();
+    if (key == "text" || key == "txt") *format = PlainText;
+    else if (key == "ansi") *format = AnsiText;
+    else if (key == "html") *format = Html;
+    else return false;
+    return true;
+}
+
+void ScrollbackExporter::run()
+{
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit finished(false, file.errorString());
+        return;
+    }
+
+    if (m_format == Html) {
+        const QString bg = m_colorScheme.value("Background", QColor(Qt::black)).name();
+        const QString fg = m_colorScheme.value("Foreground", QColor(Qt::white)).name();
+        file.write(QString("<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>qmshell scrollback</title></head>\n"
+                           "<body style=\"background-color:%1;color:%2;\"><pre style=\"font-family:monospace;\">\n")
+                   .arg(bg, fg).toUtf8());
+    }
+
+    const qint64 total = qMax<qint64>(0, m_endLine - m_firstLine);
+    SgrState state;
+    qint64 next = m_firstLine;
+    while (next < m_endLine) {
+        if (m_cancelled.loadRelaxed()) {
+            file.cancelWriting();
+            emit finished(false, QStringLiteral("Export cancelled"));
+            return;
+        }
+
+        const QStringList block = m_buffer.readLines(next, m_endLine, kExportBlockLines);
+        if (block.isEmpty()) {
+            break;
+        }
+        QByteArray chunk;
+        for (const QString &line : block) {
+            switch (m_format) {
+            case PlainText: chunk += ScrollbackBuffer::stripSgr(line).toUtf8(); break;
+            case AnsiText:  chunk += line.toUtf8(); break;
+            case Html:      chunk += SgrState::renderHtml(line, state, m_colorScheme).toUtf8(); break;
+            }
+            chunk += '\n';
+        }
+        if (file.write(chunk) != chunk.size()) {
+            file.cancelWriting();
+            emit finished(false, file.errorString());
+            return;
+        }
+        next += block.size();
+        emit progress(qMin(next - m_firstLine, total), total);
+    }
+
+    if (m_format == AnsiText) {
+        file.write("\x1b[0m");
+    } else if (m_format == Html) {
+        file.write("</pre></body></html>\n");
+    }
+
+    if (!file.commit()) {
+        emit finished(false, file.errorString());
+        return;
+    }
+    emit finished(true, m_path);
+}
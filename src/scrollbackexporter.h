@@ -0,0 +1,45 @@
+#ifndef SCROLLBACKEXPORTER_H
+#define SCROLLBACKEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QMap>
+#include <QColor>
+#include <QAtomicInt>
+
+class ScrollbackBuffer;
+
+// Writes a line range of the scrollback to a file, one block at a time, so
+// memory use doesn't grow with history size. Meant to run on a worker thread.
+class ScrollbackExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format { PlainText, AnsiText, Html };
+
+    ScrollbackExporter(const ScrollbackBuffer &buffer, qint64 firstLine, qint64 endLine,
+                       const QString &path, Format format,
+                       const QMap<QString, QColor> &colorScheme);
+
+    void cancel();
+    static bool formatFromName(const QString &name, Format *format);
+
+public slots:
+    void run();
+
+signals:
+    void progress(qint64 linesWritten, qint64 totalLines);
+    void finished(bool ok, const QString &message);
+
+private:
+    const ScrollbackBuffer &m_buffer;
+    qint64 m_firstLine;
+    qint64 m_endLine;
+    QString m_path;
+    Format m_format;
+    QMap<QString, QColor> m_colorScheme;
+    QAtomicInt m_cancelled;
+};
+
+#endif // SCROLLBACKEXPORTER_H
@@ -0,0 +1,125 @@
+#include "scrollbacksnapshot.h"
+#include "scrollbackbuffer.h"
+#include <QSaveFile>
+#include <QDataStream>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+static const char kSnapshotMagic[4] = { 'Q', 'M', 'S', 'B' };
+static const qint64 kHeaderSize = 4 + 4 + 8 + 8 + 8;
+
+ScrollbackSnapshot::~ScrollbackSnapshot()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+}
+
+bool ScrollbackSnapshot::open(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 fileSize = m_file.size();
+    if (fileSize < kHeaderSize) {
+        qWarning() << "Scrollback snapshot too small:" << path;
+        return false;
+    }
+    m_map = m_file.map(0, fileSize);
+    if (!m_map) {
+        qWarning() << "Could not map scrollback snapshot:" << path;
+        return false;
+    }
+
+    const quint32 version = qFromLittleEndian<quint32>(m_map + 4);
+    const quint64 lineCount = qFromLittleEndian<quint64>(m_map + 8);
+    const quint64 dataOffset = qFromLittleEndian<quint64>(m_map + 16);
+    const quint64 indexOffset = qFromLittleEndian<quint64>(m_map + 24);
+
+    const bool valid = memcmp(m_map, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0
+            && version == FormatVersion
+            && dataOffset >= quint64(kHeaderSize)
+            && indexOffset >= dataOffset
+            && indexOffset <= quint64(fileSize)
+            && lineCount < (quint64(fileSize) - indexOffset) / sizeof(quint64);
+    if (!valid) {
+        qWarning() << "Ignoring incompatible scrollback snapshot:" << path;
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        return false;
+    }
+
+    m_lineCount = qint64(lineCount);
+    m_data = reinterpret_cast<const char *>(m_map + dataOffset);
+    m_dataSize = indexOffset - dataOffset;
+    m_index = m_map + indexOffset;
+    return true;
+}
+
+quint64 ScrollbackSnapshot::offsetAt(qint64 index) const
+{
+    return qMin(qFromLittleEndian<quint64>(m_index + index * sizeof(quint64)), m_dataSize);
+}
+
+QByteArray ScrollbackSnapshot::rawLine(qint64 index) const
+{
+    if (index < 0 || index >= m_lineCount) {
+        return QByteArray();
+    }
+    const quint64 begin = offsetAt(index);
+    const quint64 end = qMax(begin, offsetAt(index + 1));
+    return QByteArray::fromRawData(m_data + begin, qsizetype(end - begin));
+}
+
+QString ScrollbackSnapshot::line(qint64 index) const
+{
+    const QByteArray raw = rawLine(index);
+    return QString::fromUtf8(raw.constData(), raw.size());
+}
+
+bool ScrollbackSnapshot::save(const ScrollbackBuffer &buffer, const QString &path, qint64 maxLines)
+{
+    // The trailing partial line is usually the prompt; the next shell prints its own
+    const qint64 last = buffer.position().line;
+    const qint64 first = qMax(buffer.firstLine(), last - maxLines);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write scrollback snapshot:" << path << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    // Header is rewritten once the index position is known
+    out.writeRawData(kSnapshotMagic, sizeof(kSnapshotMagic));
+    out << FormatVersion << quint64(0) << quint64(0) << quint64(0);
+
+    QList<quint64> offsets;
+    offsets.reserve(last - first + 1);
+    quint64 dataSize = 0;
+    for (qint64 n = first; n < last; ++n) {
+        offsets.append(dataSize);
+        const QByteArray bytes = buffer.utf8Line(n);
+        out.writeRawData(bytes.constData(), bytes.size());
+        dataSize += bytes.size();
+    }
+    offsets.append(dataSize);
+
+    const quint64 indexOffset = quint64(kHeaderSize) + dataSize;
+    for (quint64 offset : offsets) {
+        out << offset;
+    }
+
+    file.seek(4 + 4);
+    out << quint64(last - first) << quint64(kHeaderSize) << indexOffset;
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Could not write scrollback snapshot:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef SCROLLBACKSNAPSHOT_H
+#define SCROLLBACKSNAPSHOT_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+class ScrollbackBuffer;
+
+// Read-only, memory-mapped scrollback saved by a previous session.
+//
+// File layout (little endian):
+//   header  "QMSB", quint32 version, quint64 lineCount, quint64 dataOffset, quint64 indexOffset
+//   data    UTF-8 lines (SGR sequences inline), no separators
+//   index   (lineCount + 1) quint64 offsets into data
+// Only the lines that are actually requested get decoded.
+class ScrollbackSnapshot
+{
+public:
+    static const quint32 FormatVersion = 1;
+
+    ScrollbackSnapshot() = default;
+    ~ScrollbackSnapshot();
+    Q_DISABLE_COPY(ScrollbackSnapshot)
+
+    bool open(const QString &path);
+    qint64 lineCount() const { return m_lineCount; }
+    QString line(qint64 index) const;
+    // Undecoded bytes, valid for the lifetime of the snapshot.
+    QByteArray rawLine(qint64 index) const;
+
+    // Writes the completed lines of the buffer (at most the newest maxLines).
+    static bool save(const ScrollbackBuffer &buffer, const QString &path, qint64 maxLines);
+
+private:
+    quint64 offsetAt(qint64 index) const;
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    const uchar *m_index = nullptr;
+    const char *m_data = nullptr;
+    quint64 m_dataSize = 0;
+    qint64 m_lineCount = 0;
+};
+
+#endif // SCROLLBACKSNAPSHOT_H
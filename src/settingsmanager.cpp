@@ -1,6 +1,10 @@
 #include "settingsmanager.h"
 #include <QGuiApplication>
 
+// Bounds for the per-signal shutdown waits read from the settings file.
+static const int kMinShutdownTimeoutMs = 100;
+static const int kMaxShutdownTimeoutMs = 30000;
+
 SettingsManager::SettingsManager(QObject *parent)
     : QObject(parent)
     , m_settings(QSettings::IniFormat, QSettings::UserScope, "qmshell", "qmshell")
@@ -55,3 +59,49 @@ QString SettingsManager::loadColorSchemePath()
     m_settings.endGroup();
     return path;
 }
+
+void SettingsManager::saveSessionRestoreEnabled(bool enabled)
+{
+    m_settings.beginGroup("Terminal");
+    m_settings.setValue("restoreSession", enabled);
+    m_settings.endGroup();
+}
+
+bool SettingsManager::loadSessionRestoreEnabled()
+{
+    m_settings.beginGroup("Terminal");
+    bool enabled = m_settings.value("restoreSession", false).toBool();
+    m_settings.endGroup();
+    return enabled;
+}
+
+void SettingsManager::saveRawInputEnabled(bool enabled)
+{
+    m_settings.beginGroup("Terminal");
+    m_settings.setValue("rawInput", enabled);
+    m_settings.endGroup();
+}
+
+bool SettingsManager::loadRawInputEnabled()
+{
+    m_settings.beginGroup("Terminal");
+    bool enabled = m_settings.value("rawInput", false).toBool();
+    m_settings.endGroup();
+    return enabled;
+}
+
+QVariantMap SettingsManager::loadShutdownTimeouts()
+{
+    QVariantMap timeouts;
+    m_settings.beginGroup("Terminal");
+    // Hand-edited values are clamped so shutdown can neither skip a stage nor hang
+    auto timeout = [this](const QString &key, int defaultMs) {
+        bool ok = false;
+        const int value = m_settings.value(key, defaultMs).toInt(&ok);
+        return qBound(kMinShutdownTimeoutMs, ok ? value : defaultMs, kMaxShutdownTimeoutMs);
+    };
+    timeouts["hangupMs"] = timeout("hangupTimeoutMs", 1000);
+    timeouts["terminateMs"] = timeout("terminateTimeoutMs", 2000);
+    m_settings.endGroup();
+    return timeouts;
+}
@@ -17,6 +17,11 @@ public:
     Q_INVOKABLE QVariantMap loadTerminalSettings();
     Q_INVOKABLE void saveColorSchemePath(const QString &path);
     Q_INVOKABLE QString loadColorSchemePath();
+    Q_INVOKABLE void saveSessionRestoreEnabled(bool enabled);
+    Q_INVOKABLE bool loadSessionRestoreEnabled();
+    Q_INVOKABLE void saveRawInputEnabled(bool enabled);
+    Q_INVOKABLE bool loadRawInputEnabled();
+    Q_INVOKABLE QVariantMap loadShutdownTimeouts();
 
 
 private:
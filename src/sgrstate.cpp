@@ -0,0 +1,134 @@
+#include "sgrstate.h"
+#include "terminalcolor.h"
+#include <QStringList>
+
+void SgrState::reset()
+{
+    foregroundColor.clear();
+    backgroundColor.clear();
+    isBold = isItalic = isUnderlined = false;
+    isDim = isBlink = isInverse = isHidden = isStrikethrough = isDoubleUnderline = isOverline = false;
+}
+
+void SgrState::apply(const QString &params, const QMap<QString, QColor> &colorScheme)
+{
+    QStringList codes = params.split(';');
+    if (codes.isEmpty() || (codes.size() == 1 && codes[0].isEmpty())) {
+        codes.append("0");
+    }
+    for (int j = 0; j < codes.size(); ++j) {
+        int code = codes[j].toInt();
+
+        switch (code) {
+        case 0:  reset(); break;
+        case 1:  isBold = true; break;
+        case 2:  isDim = true; break;
+        case 3:  isItalic = true; break;
+        case 4:  isUnderlined = true; break;
+        case 5:  isBlink = true; break;
+        case 7:  isInverse = true; break;
+        case 8:  isHidden = true; break;
+        case 9:  isStrikethrough = true; break;
+        case 21: isDoubleUnderline = true; break;
+        case 22: isBold = isDim = false; break;
+        case 23: isItalic = false; break;
+        case 24: isUnderlined = isDoubleUnderline = false; break;
+        case 25: isBlink = false; break;
+        case 27: isInverse = false; break;
+        case 28: isHidden = false; break;
+        case 29: isStrikethrough = false; break;
+        case 53: isOverline = true; break;
+        case 55: isOverline = false; break;
+        case 39: foregroundColor.clear(); break;
+        case 49: backgroundColor.clear(); break;
+
+        case 38:
+            if (j + 2 < codes.size() && codes[j+1].toInt() == 5) {
+                foregroundColor = TerminalColor::ansi256ToHtmlColor(codes[j+2].toInt());
+                j += 2;
+            }
+            break;
+
+        case 48:
+            if (j + 2 < codes.size() && codes[j+1].toInt() == 5) {
+                backgroundColor = TerminalColor::ansi256ToHtmlColor(codes[j+2].toInt());
+                j += 2;
+            }
+            break;
+
+        default:
+            if ((code >= 30 && code <= 37) || (code >= 90 && code <= 97)) {
+                foregroundColor = colorFromScheme(code, colorScheme);
+            } else if ((code >= 40 && code <= 47) || (code >= 100 && code <= 107)) {
+                backgroundColor = colorFromScheme(code, colorScheme);
+            }
+            break;
+        }
+    }
+}
+
+QString SgrState::toHtml(const QString &plainText, const QMap<QString, QColor> &colorScheme) const
+{
+    QString sanitized = plainText.toHtmlEscaped();
+    QString replaced = sanitized.replace("\n", "<br>");
+
+    QString fg = foregroundColor.isEmpty() ? colorScheme.value("Foreground", QColor(Qt::white)).name() : foregroundColor;
+    QString bg = backgroundColor;
+
+    QString style;
+    if (!fg.isEmpty()) style += QStringLiteral("color:") + fg + QStringLiteral(";");
+    if (!bg.isEmpty()) style += QStringLiteral("background-color:") + bg + QStringLiteral(";");
+    if (isBold) style += QStringLiteral("font-weight:bold;");
+    if (isItalic) style += QStringLiteral("font-style:italic;");
+    if (isUnderlined) style += QStringLiteral("text-decoration:underline;");
+    if (isDim) style += QStringLiteral("opacity:0.6;");
+    if (isBlink) style += QStringLiteral("text-decoration:blink;");
+    if (isInverse) style += QStringLiteral("filter:invert(1);");
+    if (isHidden) style += QStringLiteral("visibility:hidden;");
+    if (isStrikethrough) style += QStringLiteral("text-decoration:line-through;");
+    if (isDoubleUnderline) style += QStringLiteral("text-decoration:underline double;");
+    if (isOverline) style += QStringLiteral("text-decoration:overline;");
+
+    if (style.isEmpty()) {
+        return replaced;
+    }
+    return QStringLiteral("<span style=\"") + style + QStringLiteral("\">") + replaced + QStringLiteral("</span>");
+}
+
+QString SgrState::colorFromScheme(int ansiCode, const QMap<QString, QColor> &colorScheme)
+{
+    QString key;
+    if (ansiCode >= 30 && ansiCode <= 37) key = QString("Color%1").arg(ansiCode - 30);
+    else if (ansiCode >= 40 && ansiCode <= 47) key = QString("Color%1").arg(ansiCode - 40);
+    else if (ansiCode >= 90 && ansiCode <= 97) key = QString("Color%1Intense").arg(ansiCode - 90);
+    else if (ansiCode >= 100 && ansiCode <= 107) key = QString("Color%1Intense").arg(ansiCode - 100);
+
+    if (!key.isEmpty() && colorScheme.contains(key)) {
+        return colorScheme[key].name();
+    }
+
+    return TerminalColor::ansi256ToHtmlColor(ansiCode);
+}
+
+QString SgrState::renderHtml(const QString &ansiText, SgrState &state, const QMap<QString, QColor> &colorScheme)
+{
+    QString html;
+    qsizetype start = 0;
+    while (start < ansiText.size()) {
+        const qsizetype escape = ansiText.indexOf(QStringLiteral("\x1b["), start);
+        const qsizetype textEnd = escape < 0 ? ansiText.size() : escape;
+        if (textEnd > start) {
+            html += state.toHtml(ansiText.mid(start, textEnd - start), colorScheme);
+        }
+        if (escape < 0) {
+            break;
+        }
+        const qsizetype sgrEnd = ansiText.indexOf(QChar('m'), escape + 2);
+        if (sgrEnd < 0) {
+            break;
+        }
+        state.apply(ansiText.mid(escape + 2, sgrEnd - escape - 2), colorScheme);
+        start = sgrEnd + 1;
+    }
+    return html;
+}
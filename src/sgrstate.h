@@ -0,0 +1,36 @@
+#ifndef SGRSTATE_H
+#define SGRSTATE_H
+
+#include <QString>
+#include <QMap>
+#include <QColor>
+
+// Current SGR (Select Graphic Rendition) attributes and their HTML rendering.
+// Shared by the live PTY parser and by anything that renders stored scrollback.
+struct SgrState
+{
+    QString foregroundColor;
+    QString backgroundColor;
+    bool isBold = false;
+    bool isItalic = false;
+    bool isUnderlined = false;
+    bool isDim = false;
+    bool isBlink = false;
+    bool isInverse = false;
+    bool isHidden = false;
+    bool isStrikethrough = false;
+    bool isDoubleUnderline = false;
+    bool isOverline = false;
+
+    void reset();
+    // Applies the parameters of one "ESC [ params m" sequence.
+    void apply(const QString &params, const QMap<QString, QColor> &colorScheme);
+    // Escapes plain text and wraps it in a span carrying the current attributes.
+    QString toHtml(const QString &plainText, const QMap<QString, QColor> &colorScheme) const;
+
+    static QString colorFromScheme(int ansiCode, const QMap<QString, QColor> &colorScheme);
+    // Renders scrollback text (plain text with inline SGR sequences) to HTML.
+    static QString renderHtml(const QString &ansiText, SgrState &state, const QMap<QString, QColor> &colorScheme);
+};
+
+#endif // SGRSTATE_H
@@ -1,6 +1,8 @@
 #include "terminalbackend.h"
 #include "settingsmanager.h"
-#include "terminalcolor.h"
+#include "scrollbacksnapshot.h"
+#include "keyencoder.h"
+#include "scrollbackexporter.h"
 #include <QDebug>
 #include <QSocketNotifier>
 #include <QGuiApplication>
@@ -13,6 +15,9 @@
 #include <pty.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <poll.h>
 #include <errno.h>
 #include <string.h>
 #include <QMimeData>
@@ -22,6 +27,51 @@
 #include <QTextStream>
 #include <QRegularExpression>
 #include <QMetaType>
+#include <QWindow>
+#include <QEvent>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QFile>
+#include <QDateTime>
+#include <QQuickWindow>
+#include <QQuickItem>
+#include <QKeyEvent>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QThread>
+
+// Lines kept in memory. Session snapshots keep at most kMaxSnapshotLines, and a restored
+// snapshot raises the scrollback limit to its size; restore decodes only the tail shown in the view.
+static const qsizetype kScrollbackLines = 100000;
+static const qint64 kMaxSnapshotLines = 1000000;
+static const qint64 kRestoredVisibleLines = 200;
+// Each window saves its own snapshot; only the newest few are kept for later sessions.
+static const int kMaxSessionSnapshots = 8;
+
+// Fallback reap polling when pidfd is unavailable, and the final wait after SIGKILL.
+static const int kReapPollIntervalMs = 100;
+static const int kKillTimeoutMs = 500;
+
+// Longest escape sequence carried over to the next read before it is discarded.
+static const qsizetype kMaxPendingEscapeSize = 4096;
+
+// objectName of the QML item that receives terminal keyboard input.
+static const QString kTerminalInputName = QStringLiteral("terminalInput");
+
+// Inserted into newData at each OSC 133;A so the view can index prompt positions.
+static const QString kPromptMarkerHtml = QStringLiteral("<!--qmshell-prompt-->");
+
+static qint64 utf8Length(QStringView text)
+{
+    qint64 bytes = 0;
+    for (QChar c : text) {
+        const ushort u = c.unicode();
+        if (u < 0x80) bytes += 1;
+        else if (u < 0x800 || c.isSurrogate()) bytes += 2; // a surrogate pair is 4 bytes total
+        else bytes += 3;
+    }
+    return bytes;
+}
 
 // Theme Management
 void TerminalBackend::discoverColorSchemes(const QString &directory)
@@ -109,8 +159,8 @@ void TerminalBackend::applyColorScheme(const QString &filePath, bool isLiveChang
     QColor defaultFg = m_colorScheme.value("Foreground");
     if (!defaultFg.isValid()) defaultFg = QColor(Qt::white);
 
-    m_foregroundColor = defaultFg.name();
-    m_backgroundColor = defaultBg.name();
+    m_sgr.foregroundColor = defaultFg.name();
+    m_sgr.backgroundColor = defaultBg.name();
 
     // Emit the full theme map for other UI components
     QVariantMap colorMap;
@@ -125,26 +175,12 @@ void TerminalBackend::applyColorScheme(const QString &filePath, bool isLiveChang
     //qDebug() << "Applied color scheme:" << filePath;
 }
 
-QString TerminalBackend::getColorFromScheme(int ansiCode)
-{
-    QString key;
-    if (ansiCode >= 30 && ansiCode <= 37) key = QString("Color%1").arg(ansiCode - 30);
-    else if (ansiCode >= 40 && ansiCode <= 47) key = QString("Color%1").arg(ansiCode - 40);
-    else if (ansiCode >= 90 && ansiCode <= 97) key = QString("Color%1Intense").arg(ansiCode - 90);
-    else if (ansiCode >= 100 && ansiCode <= 107) key = QString("Color%1Intense").arg(ansiCode - 100);
-
-    if (!key.isEmpty() && m_colorScheme.contains(key)) {
-        return m_colorScheme[key].name();
-    }
-
-    return TerminalColor::ansi256ToHtmlColor(ansiCode);
-}
-
 
 // PTY and Process Management
 
 TerminalBackend::TerminalBackend(QObject *parent, const QString &startDir)
-    : QObject(parent), m_startDir(startDir), m_passwordMode(false)
+    : QObject(parent), m_startDir(startDir), m_scrollback(kScrollbackLines, kMaxSnapshotLines),
+      m_passwordMode(false)
 {
     qRegisterMetaType<QString>("QString");
 
@@ -166,8 +202,17 @@ void TerminalBackend::startTerminal()
         m_colorScheme["Background"] = QColor(Qt::black);
         m_colorScheme["Foreground"] = QColor(Qt::white);
         // Default palette
-        m_foregroundColor = m_colorScheme["Foreground"].name();
-        m_backgroundColor = m_colorScheme["Background"].name();
+        m_sgr.foregroundColor = m_colorScheme["Foreground"].name();
+        m_sgr.backgroundColor = m_colorScheme["Background"].name();
+    }
+
+    setRawInputMode(settings.loadRawInputEnabled());
+    QVariantMap shutdownTimeouts = settings.loadShutdownTimeouts();
+    m_hangupTimeoutMs = shutdownTimeouts.value("hangupMs").toInt();
+    m_terminateTimeoutMs = shutdownTimeouts.value("terminateMs").toInt();
+
+    if (settings.loadSessionRestoreEnabled()) {
+        restoreSession();
     }
 
     struct winsize ws;
@@ -176,6 +221,8 @@ void TerminalBackend::startTerminal()
     ws.ws_xpixel = 0;
     ws.ws_ypixel = 0;
 
+    const QByteArray rcFile = QFile::encodeName(installShellIntegration());
+
     pid_t pid = forkpty(&m_masterFd, nullptr, nullptr, &ws);
     if (pid < 0) {
         qWarning() << "forkpty failed:" << strerror(errno);
@@ -201,11 +248,18 @@ void TerminalBackend::startTerminal()
         setenv("PS1", "\\[\\033[01;32m\\]\\u@\\h\\[\\033[00m\\]:\\[\\033[01;34m\\]\\w\\[\\033[00m\\]\\$ ", 1);
         setenv("PS2", "> ", 1);
 
-        struct termios tty;
-        tcgetattr(STDIN_FILENO, &tty);
-        tty.c_lflag &= ~(ECHO | ICANON);
-        tcsetattr(STDIN_FILENO, TCSANOW, &tty);
+        // The view echoes and edits the line itself unless raw input hands that to the shell
+        if (!m_rawInputMode) {
+            struct termios tty;
+            tcgetattr(STDIN_FILENO, &tty);
+            tty.c_lflag &= ~(ECHO | ICANON);
+            tcsetattr(STDIN_FILENO, TCSANOW, &tty);
+        }
 
+        // The wrapper sources ~/.bashrc and then adds the OSC 133 prompt marks
+        if (!rcFile.isEmpty()) {
+            execlp("bash", "bash", "--rcfile", rcFile.constData(), "-i", (char*)nullptr);
+        }
         execlp("bash", "bash", "-i", (char*)nullptr);
         _exit(1);
     }
@@ -219,68 +273,259 @@ void TerminalBackend::startTerminal()
             if (n > 0) {
                 processTerminalOutput(QByteArray(buffer, n));
             } else if (n <= 0) {
-                emit newData("\n[Process completed]");
                 notifier->setEnabled(false);
+                reapChild();
             }
         });
+        watchChild();
+    }
+}
+
+// Copies the bundled rc wrapper to disk so bash can read it; returns an empty path on failure.
+QString TerminalBackend::installShellIntegration() const
+{
+    QFile resource(":/data/shell-integration.bash");
+    if (!resource.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    const QByteArray script = resource.readAll();
+
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    const QString path = dir + "/shell-integration.bash";
+    QFile installed(path);
+    if (installed.open(QIODevice::ReadOnly) && installed.readAll() == script) {
+        return path;
+    }
+    installed.close();
+
+    QDir().mkpath(dir);
+    if (!installed.open(QIODevice::WriteOnly | QIODevice::Truncate) || installed.write(script) != script.size()) {
+        qWarning() << "Could not install shell integration script:" << path;
+        return QString();
+    }
+    return path;
+}
+
+// Child Lifecycle
+
+void TerminalBackend::watchChild()
+{
+#ifdef SYS_pidfd_open
+    m_pidFd = int(syscall(SYS_pidfd_open, m_childPid, 0));
+#endif
+    if (m_pidFd < 0) {
+        // Pre-5.3 kernel: fall back to noticing EOF on the PTY and polling waitpid
+        return;
     }
+    m_exitNotifier = new QSocketNotifier(m_pidFd, QSocketNotifier::Read, this);
+    connect(m_exitNotifier, &QSocketNotifier::activated, this, &TerminalBackend::reapChild);
 }
 
+void TerminalBackend::drainOutput()
+{
+    if (m_masterFd < 0) {
+        return;
+    }
+    // Pick up whatever the child wrote before exiting without blocking on the PTY
+    struct pollfd pfd = { m_masterFd, POLLIN, 0 };
+    char buffer[4096];
+    while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+        ssize_t n = read(m_masterFd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        processTerminalOutput(QByteArray(buffer, n));
+    }
+}
+
+void TerminalBackend::reapChild()
+{
+    if (m_childPid <= 0) {
+        return;
+    }
+    int status = 0;
+    pid_t result = waitpid(m_childPid, &status, WNOHANG);
+    if (result == 0) {
+        if (m_pidFd < 0) {
+            QTimer::singleShot(kReapPollIntervalMs, this, &TerminalBackend::reapChild);
+        }
+        return;
+    }
+
+    m_childPid = -1;
+    // The notifier must not outlive the fd it watches; this may run from its own activated()
+    if (m_exitNotifier) {
+        m_exitNotifier->setEnabled(false);
+        m_exitNotifier->deleteLater();
+        m_exitNotifier = nullptr;
+    }
+    if (m_pidFd >= 0) {
+        close(m_pidFd);
+        m_pidFd = -1;
+    }
+
+    int exitCode = -1;
+    if (result > 0) {
+        exitCode = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+    }
+    drainOutput();
+    if (exitCode > 0) {
+        deliverHtml(QString("\n[Process exited with code %1]").arg(exitCode));
+    } else {
+        deliverHtml(QStringLiteral("\n[Process completed]"));
+    }
+    emit processExited(exitCode);
+}
+
+bool TerminalBackend::waitForChildExit(int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (m_childPid > 0) {
+        if (waitpid(m_childPid, nullptr, WNOHANG) != 0) {
+            m_childPid = -1;
+            return true;
+        }
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0) {
+            return false;
+        }
+        if (m_pidFd >= 0) {
+            struct pollfd pfd = { m_pidFd, POLLIN, 0 };
+            poll(&pfd, 1, int(remaining));
+        } else {
+            usleep(qMin<qint64>(remaining, 10) * 1000);
+        }
+    }
+    return true;
+}
+
+// The group's processes are not our children, so there is nothing to reap; poll until it is empty.
+bool TerminalBackend::waitForGroupExit(pid_t group, int timeoutMs) const
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (kill(-group, 0) == 0) {
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0) {
+            return false;
+        }
+        usleep(qMin<qint64>(remaining, 10) * 1000);
+    }
+    return true;
+}
 
 TerminalBackend::~TerminalBackend()
 {
+    if (m_exportThread) {
+        m_exporter->cancel();
+        m_exportThread->quit();
+        m_exportThread->wait();
+        delete m_exporter;
+    }
+
+    // A foreground job runs in its own process group and can outlive the shell, so it gets
+    // every stage too; never our own group, and not the shell's, which kill(m_childPid) covers
+    const pid_t foregroundGroup = m_masterFd >= 0 ? tcgetpgrp(m_masterFd) : -1;
+    const bool signalGroup = foregroundGroup > 0 && foregroundGroup != m_childPid && foregroundGroup != getpgrp();
+
+    // Closing the master hangs up the tty, which already SIGHUPs the session
     if (m_masterFd >= 0) close(m_masterFd);
-    if (m_childPid > 0) {
-        kill(m_childPid, SIGTERM);
-        waitpid(m_childPid, nullptr, 0);
+    if (m_childPid > 0 || signalGroup) {
+        // Escalate so a shell or job that ignores SIGHUP/SIGTERM can't stall shutdown
+        const int stopSignals[] = { SIGHUP, SIGTERM, SIGKILL };
+        const int timeouts[] = { m_hangupTimeoutMs, m_terminateTimeoutMs, kKillTimeoutMs };
+        for (int i = 0; i < 3; ++i) {
+            const bool groupAlive = signalGroup && kill(-foregroundGroup, stopSignals[i]) == 0;
+            if (m_childPid > 0) {
+                kill(m_childPid, stopSignals[i]);
+            }
+            QElapsedTimer timer;
+            timer.start();
+            const bool shellExited = waitForChildExit(timeouts[i]);
+            if (shellExited && (!groupAlive || waitForGroupExit(foregroundGroup, int(timeouts[i] - timer.elapsed())))) {
+                break;
+            }
+        }
+        if (m_childPid > 0) {
+            qWarning() << "Child process" << m_childPid << "did not exit after SIGKILL";
+        }
     }
+    delete m_exitNotifier;
+    m_exitNotifier = nullptr;
+    if (m_pidFd >= 0) close(m_pidFd);
 }
 
 //  ANSI Parsing and Data Processing
 
-QString TerminalBackend::parseAnsiToHtml(const QString &text)
+QString TerminalBackend::parseAnsiToHtml(const QString &input)
 {
     QString htmlOutput;
     QString currentText;
+    const QString text = m_pendingEscape + input;
+    m_pendingEscape.clear();
+
+    auto stashIncompleteEscape = [&](int start) {
+        if (text.size() - start <= kMaxPendingEscapeSize) {
+            m_pendingEscape = text.mid(start);
+        }
+    };
 
     auto flushCurrentText = [&]() {
         if (!currentText.isEmpty()) {
-            QString sanitized = currentText.toHtmlEscaped();
-            QString replaced = sanitized.replace("\n", "<br>");
-
-            QString fg = m_foregroundColor.isEmpty() ? m_colorScheme.value("Foreground", QColor(Qt::white)).name() : m_foregroundColor;
-            QString bg = m_backgroundColor;
-
-
-            QString style;
-            if (!fg.isEmpty()) style += QStringLiteral("color:") + fg + QStringLiteral(";");
-            if (!bg.isEmpty()) style += QStringLiteral("background-color:") + bg + QStringLiteral(";");
-            if (m_isBold) style += QStringLiteral("font-weight:bold;");
-            if (m_isItalic) style += QStringLiteral("font-style:italic;");
-            if (m_isUnderlined) style += QStringLiteral("text-decoration:underline;");
-            if (m_isDim) style += QStringLiteral("opacity:0.6;");
-            if (m_isBlink) style += QStringLiteral("text-decoration:blink;");
-            if (m_isInverse) style += QStringLiteral("filter:invert(1);");
-            if (m_isHidden) style += QStringLiteral("visibility:hidden;");
-            if (m_isStrikethrough) style += QStringLiteral("text-decoration:line-through;");
-            if (m_isDoubleUnderline) style += QStringLiteral("text-decoration:underline double;");
-            if (m_isOverline) style += QStringLiteral("text-decoration:overline;");
-
-            if (!style.isEmpty()) {
-                htmlOutput += QStringLiteral("<span style=\"") + style + QStringLiteral("\">") + replaced + QStringLiteral("</span>");
-            } else {
-                htmlOutput += replaced;
-            }
+            m_scrollback.appendText(currentText);
+            m_promptIndex.addOutputBytes(utf8Length(currentText));
+
+            htmlOutput += m_sgr.toHtml(currentText, m_colorScheme);
             currentText.clear();
         }
     };
 
+    // Line editing follows the raw input setting but only switches where a line begins
+    auto updateLineEditing = [&]() {
+        if (m_lineEditing == m_rawInputMode) {
+            return;
+        }
+        if (m_lineEditing ? !m_currentLine.isEmpty() : m_scrollback.position().column != 0) {
+            return;
+        }
+        m_lineEditing = m_rawInputMode;
+        if (m_lineEditing) {
+            m_currentLine.reset(m_activeSgr.isEmpty());
+        } else if (!m_activeSgr.isEmpty()) {
+            // Edited lines end in the default state; restate what the following text expects
+            m_scrollback.appendText(QStringLiteral("\x1b[0m") + m_activeSgr);
+        }
+    };
+
+    auto syncCurrentLine = [&]() {
+        if (m_lineEditing) {
+            m_scrollback.setCurrentLine(m_currentLine.toAnsi());
+        }
+    };
+
+    auto commitCurrentLine = [&]() {
+        syncCurrentLine();
+        m_scrollback.appendText(QStringLiteral("\n"));
+        m_promptIndex.addOutputBytes(1);
+        htmlOutput += m_currentLine.toHtml(m_colorScheme) + QStringLiteral("<br>");
+        m_currentLine.newLine();
+        m_currentLineDirty = true;
+    };
+
+    updateLineEditing();
+
     for (int i = 0; i < text.size(); ++i) {
         QChar c = text[i];
 
         if (c == QChar('\x1B')) { // Start of an escape sequence
             flushCurrentText();
-            if (i + 1 < text.size() && text[i + 1] == QChar('[')) {
+            const int escapeStart = i;
+            if (i + 1 >= text.size()) {
+                stashIncompleteEscape(escapeStart);
+                break;
+            }
+            if (text[i + 1] == QChar('[')) {
                 i++; // Consume '['
                 QString params;
                 while (i + 1 < text.size() && ( (text[i + 1] >= QChar('0') && text[i + 1] <= QChar('9')) || text[i+1] == QChar(';') || text[i+1] == QChar('?')) ) {
@@ -291,80 +536,112 @@ QString TerminalBackend::parseAnsiToHtml(const QString &text)
                     i++;
                     QChar finalByte = text[i];
                     if (finalByte == QChar('m')) {
-                        QStringList codes = params.split(';');
-                        if (codes.isEmpty() || (codes.size() == 1 && codes[0].isEmpty())) {
-                            codes.append("0");
-                        }
-                        for (int j = 0; j < codes.size(); ++j) {
-                            int code = codes[j].toInt();
-
-                            switch (code) {
-                            case 0:
-                                m_foregroundColor.clear();
-                                m_backgroundColor.clear();
-                                m_isBold = m_isItalic = m_isUnderlined = false;
-                                m_isDim = m_isBlink = m_isInverse = m_isHidden = m_isStrikethrough = m_isDoubleUnderline = m_isOverline = false;
-                                break;
-                            case 1:  m_isBold = true; break;
-                            case 2:  m_isDim = true; break;
-                            case 3:  m_isItalic = true; break;
-                            case 4:  m_isUnderlined = true; break;
-                            case 5:  m_isBlink = true; break;
-                            case 7:  m_isInverse = true; break;
-                            case 8:  m_isHidden = true; break;
-                            case 9:  m_isStrikethrough = true; break;
-                            case 21: m_isDoubleUnderline = true; break;
-                            case 22: m_isBold = m_isDim = false; break;
-                            case 23: m_isItalic = false; break;
-                            case 24: m_isUnderlined = m_isDoubleUnderline = false; break;
-                            case 25: m_isBlink = false; break;
-                            case 27: m_isInverse = false; break;
-                            case 28: m_isHidden = false; break;
-                            case 29: m_isStrikethrough = false; break;
-                            case 53: m_isOverline = true; break;
-                            case 55: m_isOverline = false; break;
-                            case 39: m_foregroundColor.clear(); break;
-                            case 49: m_backgroundColor.clear(); break;
-
-                            case 38:
-                                if (j + 2 < codes.size() && codes[j+1].toInt() == 5) {
-                                    m_foregroundColor = TerminalColor::ansi256ToHtmlColor(codes[j+2].toInt());
-                                    j += 2;
-                                }
-                                break;
-
-                            case 48:
-                                if (j + 2 < codes.size() && codes[j+1].toInt() == 5) {
-                                    m_backgroundColor = TerminalColor::ansi256ToHtmlColor(codes[j+2].toInt());
-                                    j += 2;
-                                }
-                                break;
-
-                            default:
-                                if ((code >= 30 && code <= 37) || (code >= 90 && code <= 97)) {
-                                    m_foregroundColor = getColorFromScheme(code);
-                                } else if ((code >= 40 && code <= 47) || (code >= 100 && code <= 107)) {
-                                    m_backgroundColor = getColorFromScheme(code);
-                                }
-                                break;
-                            }
+                        if (!m_lineEditing) {
+                            m_scrollback.appendSgr(params);
                         }
+                        m_sgr.apply(params, m_colorScheme);
+                        trackActiveSgr(params);
+                    } else if ((finalByte == QChar('h') || finalByte == QChar('l')) && params.startsWith(QChar('?'))) {
+                        setPrivateMode(params.mid(1), finalByte == QChar('h'));
+                    } else if (m_lineEditing && editCurrentLine(finalByte, params)) {
+                        m_currentLineDirty = true;
                     }
+                } else if (i + 1 >= text.size()) {
+                    stashIncompleteEscape(escapeStart);
+                    break;
                 }
             }
-            else if (i + 1 < text.size() && text[i + 1] == QChar(']')) {
+            else if (text[i + 1] == QChar('=') || text[i + 1] == QChar('>')) {
+                i++; // DECKPAM / DECKPNM
+                m_applicationKeypad = text[i] == QChar('=');
+            }
+            else if (text[i + 1] == QChar(']')) {
                 i++; // Consume ']'
-                while (i + 1 < text.size() && text[i + 1] != QChar('\x07')) { i++; }
-                if (i + 1 < text.size()) { i++; }
+                QString payload;
+                bool terminated = false;
+                while (i + 1 < text.size()) {
+                    i++;
+                    if (text[i] == QChar('\x07')) { terminated = true; break; }
+                    if (text[i] == QChar('\x1B') && i + 1 < text.size() && text[i + 1] == QChar('\\')) {
+                        i++; // String terminator ESC '\\'
+                        terminated = true;
+                        break;
+                    }
+                    payload += text[i];
+                }
+                if (!terminated) {
+                    stashIncompleteEscape(escapeStart);
+                    break;
+                }
+                if (payload.startsWith(QLatin1String("133;"))) {
+                    // Marks are recorded at scrollback positions, so the edited line must be current
+                    syncCurrentLine();
+                    if (handleShellIntegrationMark(payload.mid(4))) {
+                        htmlOutput += kPromptMarkerHtml;
+                    }
+                }
+            }
+        } else if (m_lineEditing) {
+            if (c == QChar('\n')) {
+                commitCurrentLine();
+                updateLineEditing();
+                continue;
+            }
+            if (c == QChar('\r')) {
+                m_currentLine.carriageReturn();
+            } else if (c == QChar('\b')) {
+                m_currentLine.backspace();
+            } else if (c == QChar('\t')) {
+                m_currentLine.tab();
+            } else if (c >= QChar(0x20) && c != QChar(0x7F)) {
+                m_currentLine.put(c, m_activeSgr);
+                m_promptIndex.addOutputBytes(utf8Length(QStringView(&c, 1)));
+            } else {
+                continue;
             }
+            m_currentLineDirty = true;
         } else if (c != QChar('\r') && c != QChar('\b')) {
             currentText += c;
+            if (c == QChar('\n') && m_lineEditing != m_rawInputMode) {
+                flushCurrentText();
+                updateLineEditing();
+            }
         }
     }
     flushCurrentText();
+    syncCurrentLine();
     return htmlOutput;
 }
 
+// SGR sequences since the last reset, i.e. what a cell printed now needs to render the same later
+void TerminalBackend::trackActiveSgr(const QString &params)
+{
+    if (params.isEmpty() || params.section(';', 0, 0).toInt() == 0) {
+        m_activeSgr.clear();
+        if (params.contains(QChar(';'))) {
+            m_activeSgr = QStringLiteral("\x1b[") + params + QChar('m');
+        }
+    } else {
+        m_activeSgr += QStringLiteral("\x1b[") + params + QChar('m');
+    }
+}
+
+// Cursor movement and erasure within the current line; returns true if the sequence was handled.
+bool TerminalBackend::editCurrentLine(QChar finalByte, const QString &params)
+{
+    const int count = qMax(1, params.section(';', 0, 0).toInt());
+    switch (finalByte.unicode()) {
+    case 'K': m_currentLine.erase(params.toInt()); return true;
+    case 'D': m_currentLine.moveBy(-count); return true;
+    case 'C': m_currentLine.moveBy(count); return true;
+    case 'G': m_currentLine.moveTo(count - 1); return true;
+    case 'P': m_currentLine.deleteChars(count); return true;
+    case 'X': m_currentLine.eraseChars(count); return true;
+    case '@': m_currentLine.insertBlanks(count); return true;
+    default: return false;
+    }
+}
+
 void TerminalBackend::processTerminalOutput(const QByteArray &data)
 {
     QString text = QString::fromUtf8(data);
@@ -379,9 +656,461 @@ void TerminalBackend::processTerminalOutput(const QByteArray &data)
     }
 
     QString html = parseAnsiToHtml(text);
-    if (!html.isEmpty()) {
+    // While hidden the output only lands in m_scrollback; the catch-up frame renders it later
+    if (m_viewVisible) {
+        if (!html.isEmpty()) {
+            emit newData(html);
+        }
+        if (m_currentLineDirty) {
+            emit currentLineUpdated(m_currentLine.toHtml(m_colorScheme), m_currentLine.cursor());
+        }
+    }
+    m_currentLineDirty = false;
+}
+
+// For messages that are not part of the PTY stream (and so not in the scrollback)
+void TerminalBackend::deliverHtml(const QString &html)
+{
+    if (m_viewVisible) {
         emit newData(html);
+        if (m_lineEditing && !m_currentLine.isEmpty()) {
+            // newData drops the view's copy of the edited line; put it back below the notice
+            emit currentLineUpdated(m_currentLine.toHtml(m_colorScheme), m_currentLine.cursor());
+        }
+    } else {
+        m_pendingNotices.append(html);
+    }
+}
+
+// Renders the scrollback between two positions (to the end if `to` is invalid), re-inserting prompt markers.
+// initialSgr holds the SGR sequences already in effect at `from`.
+QString TerminalBackend::renderScrollbackHtml(const ScrollbackPosition &from, const ScrollbackPosition &to,
+                                              const QString &initialSgr) const
+{
+    auto after = [](const ScrollbackPosition &pos, const ScrollbackPosition &ref) {
+        return pos.line > ref.line || (pos.line == ref.line && pos.column > ref.column);
+    };
+
+    // Prompt records are in scrollback order, so walk back only as far as needed
+    QList<ScrollbackPosition> marks;
+    for (int i = m_promptIndex.size() - 1; i >= 0; --i) {
+        const ScrollbackPosition &prompt = m_promptIndex.at(i).promptStart;
+        if (!after(prompt, from)) {
+            break;
+        }
+        if (!to.isValid() || !after(prompt, to)) {
+            marks.prepend(prompt);
+        }
+    }
+
+    SgrState state;
+    SgrState::renderHtml(initialSgr, state, m_colorScheme);
+    QString html;
+    ScrollbackPosition segmentStart = from;
+    for (const ScrollbackPosition &mark : marks) {
+        html += SgrState::renderHtml(m_scrollback.text(segmentStart, mark, true), state, m_colorScheme);
+        html += kPromptMarkerHtml;
+        segmentStart = mark;
+    }
+    html += SgrState::renderHtml(m_scrollback.text(segmentStart, to, true), state, m_colorScheme);
+    return html;
+}
+
+// Shell Integration (OSC 133)
+
+// Returns true for a prompt-start mark so the caller can tag the HTML stream.
+bool TerminalBackend::handleShellIntegrationMark(const QString &mark)
+{
+    const QStringList parts = mark.split(';');
+    const QString kind = parts.value(0);
+    const ScrollbackPosition pos = m_scrollback.position();
+
+    if (kind == QLatin1String("A")) {
+        m_promptIndex.markPromptStart(pos);
+        return true;
     }
+    if (kind == QLatin1String("B")) {
+        m_promptIndex.markCommandStart(pos);
+    } else if (kind == QLatin1String("C")) {
+        m_promptIndex.markOutputStart(pos);
+        if (m_lineDisciplinePending) {
+            // readline has just restored its saved termios; re-apply before the command reads them
+            applyLineDiscipline();
+            m_lineDisciplinePending = false;
+        }
+    } else if (kind == QLatin1String("D")) {
+        bool ok = false;
+        const int exitCode = parts.value(1).toInt(&ok);
+        if (m_promptIndex.markOutputEnd(pos, ok ? exitCode : -1)) {
+            emit commandFinished(commandInfo(*m_promptIndex.lastCommand()));
+        }
+    }
+    return false;
+}
+
+QVariantMap TerminalBackend::commandInfo(const CommandRecord &record) const
+{
+    QVariantMap info;
+    if (record.commandStart.isValid() && record.outputStart.isValid()) {
+        info["command"] = m_scrollback.text(record.commandStart, record.outputStart).trimmed();
+    }
+    info["promptLine"] = record.promptStart.line;
+    info["outputLine"] = record.outputStart.line;
+    info["running"] = record.running;
+    info["exitCode"] = record.exitCode;
+    info["wallTimeMs"] = record.wallTimeMs;
+    info["outputBytes"] = record.outputBytes;
+    return info;
+}
+
+QString TerminalBackend::lastCommandOutput() const
+{
+    const CommandRecord *record = m_promptIndex.lastCommand();
+    if (!record) {
+        return QString();
+    }
+    // A running command has no end mark yet; take everything up to now
+    return m_scrollback.text(record->outputStart, record->outputEnd);
+}
+
+QVariantMap TerminalBackend::lastCommandInfo() const
+{
+    const CommandRecord *record = m_promptIndex.lastCommand();
+    return record ? commandInfo(*record) : QVariantMap();
+}
+
+void TerminalBackend::clearScrollback()
+{
+    m_scrollback.clear();
+    m_promptIndex.clear();
+}
+
+// Raw Key Input
+
+void TerminalBackend::setPrivateMode(const QString &params, bool enabled)
+{
+    const QStringList modes = params.split(';');
+    for (const QString &mode : modes) {
+        switch (mode.toInt()) {
+        case 1:    m_applicationCursorKeys = enabled; break;
+        case 47:
+        case 1047:
+        case 1049: m_alternateScreen = enabled; break;
+        case 2004: m_bracketedPaste = enabled; break;
+        default: break;
+        }
+    }
+}
+
+bool TerminalBackend::rawInputMode() const
+{
+    return m_rawInputMode;
+}
+
+void TerminalBackend::setRawInputMode(bool enabled)
+{
+    if (m_rawInputMode == enabled) {
+        return;
+    }
+    m_rawInputMode = enabled;
+    if (m_masterFd >= 0) {
+        applyLineDiscipline();
+        m_lineDisciplinePending = true;
+    }
+    emit rawInputModeChanged(m_rawInputMode);
+}
+
+// Raw input leaves echo and line editing to the child tty, as in any other terminal;
+// otherwise the view does both. Termios calls on the master apply to the slave side.
+void TerminalBackend::applyLineDiscipline()
+{
+    struct termios tty;
+    if (tcgetattr(m_masterFd, &tty) != 0) {
+        return;
+    }
+    if (m_rawInputMode) {
+        tty.c_lflag |= ECHO | ICANON;
+    } else {
+        tty.c_lflag &= ~(ECHO | ICANON);
+    }
+    tcsetattr(m_masterFd, TCSANOW, &tty);
+}
+
+bool TerminalBackend::rawInputActive() const
+{
+    return (m_rawInputMode || m_alternateScreen) && m_masterFd >= 0;
+}
+
+// Runs from the window event filter, before QML sees the key.
+// Returns false to let the event continue to the view.
+bool TerminalBackend::handleRawKey(QKeyEvent *event)
+{
+    QQuickWindow *window = qobject_cast<QQuickWindow *>(m_trackedWindow);
+    QQuickItem *focusItem = window ? window->activeFocusItem() : nullptr;
+    if (!focusItem || focusItem->objectName() != kTerminalInputName) {
+        return false;
+    }
+    // Ctrl+Shift+C / Ctrl+Shift+V (clipboard) and Ctrl+Shift+Up / Ctrl+Shift+Down (prompt jumps) stay with the view
+    const Qt::KeyboardModifiers mods = event->modifiers() & ~Qt::KeyboardModifiers(Qt::KeypadModifier);
+    if (mods == (Qt::ControlModifier | Qt::ShiftModifier)
+            && (event->key() == Qt::Key_C || event->key() == Qt::Key_V
+                || event->key() == Qt::Key_Up || event->key() == Qt::Key_Down)) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray bytes = KeyEncoder::encode(event->key(), event->modifiers(), event->text(),
+                                                m_applicationCursorKeys, m_applicationKeypad);
+    if (bytes.isEmpty()) {
+        return false;
+    }
+    ::write(m_masterFd, bytes.constData(), bytes.size());
+
+    m_keyLastNs = timer.nsecsElapsed();
+    m_keyTotalNs += m_keyLastNs;
+    ++m_keyCount;
+    return true;
+}
+
+QVariantMap TerminalBackend::keyLatencyStats() const
+{
+    QVariantMap stats;
+    stats["count"] = m_keyCount;
+    stats["lastUs"] = m_keyLastNs / 1000.0;
+    stats["averageUs"] = m_keyCount > 0 ? m_keyTotalNs / 1000.0 / m_keyCount : 0.0;
+    return stats;
+}
+
+// Scrollback Export
+
+bool TerminalBackend::saveScrollback(const QString &fileUrl, const QString &format)
+{
+    if (m_exportThread) {
+        qWarning() << "Scrollback export already running";
+        return false;
+    }
+    ScrollbackExporter::Format exportFormat;
+    if (!ScrollbackExporter::formatFromName(format, &exportFormat)) {
+        qWarning() << "Unknown scrollback export format:" << format;
+        return false;
+    }
+    const QUrl url(fileUrl);
+    const QString path = url.isLocalFile() ? url.toLocalFile() : fileUrl;
+
+    // The exporter reads the live buffer block by block under its lock, so nothing is copied up front
+    m_exporter = new ScrollbackExporter(m_scrollback, m_scrollback.firstLine(), m_scrollback.endLine(),
+                                        path, exportFormat, m_colorScheme);
+    m_exportThread = new QThread(this);
+    m_exporter->moveToThread(m_exportThread);
+    connect(m_exportThread, &QThread::started, m_exporter, &ScrollbackExporter::run);
+    connect(m_exporter, &ScrollbackExporter::progress, this, [this](qint64 written, qint64 total) {
+        emit scrollbackExportProgress(total > 0 ? double(written) / total : 1.0);
+    });
+    connect(m_exporter, &ScrollbackExporter::finished, this, [this](bool ok, const QString &message) {
+        m_exportThread->quit();
+        m_exportThread->wait();
+        delete m_exporter;
+        m_exporter = nullptr;
+        m_exportThread->deleteLater();
+        m_exportThread = nullptr;
+        emit scrollbackExportFinished(ok, message);
+    });
+    m_exportThread->start(QThread::LowPriority);
+    return true;
+}
+
+void TerminalBackend::cancelScrollbackExport()
+{
+    if (m_exporter) {
+        m_exporter->cancel();
+    }
+}
+
+// Session Snapshot
+
+QString TerminalBackend::sessionDirectory() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/sessions";
+}
+
+// Claimed snapshots of instances that died without saving go back into the pool
+void TerminalBackend::recoverOrphanedSessions(const QDir &dir) const
+{
+    const QFileInfoList claimed = dir.entryInfoList({ "claimed-*.qmsb" }, QDir::Files);
+    for (const QFileInfo &info : claimed) {
+        bool ok = false;
+        const pid_t owner = info.completeBaseName().section('-', 1).toInt(&ok);
+        if (!ok || owner == getpid() || (kill(owner, 0) < 0 && errno == ESRCH)) {
+            const QString name = QString("session-%1-%2.qmsb")
+                                     .arg(info.lastModified().toMSecsSinceEpoch(), 13, 10, QChar('0'))
+                                     .arg(ok ? owner : 0);
+            dir.rename(info.fileName(), name);
+        }
+    }
+}
+
+void TerminalBackend::restoreSession()
+{
+    QDir dir(sessionDirectory());
+    if (!dir.exists()) {
+        return;
+    }
+    recoverOrphanedSessions(dir);
+
+    // Newest first; renaming is atomic, so two windows starting together never share a snapshot
+    const QString claimedName = QString("claimed-%1.qmsb").arg(getpid());
+    const QStringList candidates = dir.entryList({ "session-*.qmsb" }, QDir::Files, QDir::Name | QDir::Reversed);
+    for (const QString &name : candidates) {
+        if (dir.rename(name, claimedName)) {
+            m_claimedSnapshotPath = dir.filePath(claimedName);
+            break;
+        }
+    }
+    if (m_claimedSnapshotPath.isEmpty()) {
+        return;
+    }
+
+    QSharedPointer<ScrollbackSnapshot> snapshot(new ScrollbackSnapshot);
+    if (!snapshot->open(m_claimedSnapshotPath) || snapshot->lineCount() == 0) {
+        return;
+    }
+    m_scrollback.attachSnapshot(snapshot);
+
+    // Decode only what the view can show; older lines stay in the mapping
+    const qint64 last = m_scrollback.position().line;
+    const qint64 first = qMax(m_scrollback.firstLine(), last - kRestoredVisibleLines);
+    deliverHtml(renderScrollbackHtml({ first, 0 }));
+}
+
+void TerminalBackend::saveSession()
+{
+    SettingsManager settings;
+    QDir dir(sessionDirectory());
+    if (!settings.loadSessionRestoreEnabled()) {
+        // Don't leave stale history behind once the option is turned off
+        const QStringList stale = dir.entryList({ "session-*.qmsb" }, QDir::Files);
+        for (const QString &name : stale) {
+            dir.remove(name);
+        }
+        if (!m_claimedSnapshotPath.isEmpty()) {
+            QFile::remove(m_claimedSnapshotPath);
+        }
+        return;
+    }
+
+    dir.mkpath(".");
+    const QString name = QString("session-%1-%2.qmsb")
+                             .arg(QDateTime::currentMSecsSinceEpoch(), 13, 10, QChar('0'))
+                             .arg(getpid());
+    // The claimed file may still back the oldest lines, so it is only dropped after the save
+    if (!ScrollbackSnapshot::save(m_scrollback, dir.filePath(name), kMaxSnapshotLines)) {
+        return;
+    }
+    if (!m_claimedSnapshotPath.isEmpty()) {
+        QFile::remove(m_claimedSnapshotPath);
+        m_claimedSnapshotPath.clear();
+    }
+
+    const QStringList saved = dir.entryList({ "session-*.qmsb" }, QDir::Files, QDir::Name | QDir::Reversed);
+    for (qsizetype i = kMaxSessionSnapshots; i < saved.size(); ++i) {
+        dir.remove(saved.at(i));
+    }
+}
+
+// View Visibility Throttling
+
+bool TerminalBackend::viewVisible() const
+{
+    return m_viewVisible;
+}
+
+void TerminalBackend::setViewVisible(bool visible)
+{
+    if (m_viewVisible == visible) {
+        return;
+    }
+    m_viewVisible = visible;
+    if (m_viewVisible) {
+        flushPendingOutput();
+    } else {
+        // An edited line is re-sent whole, so catch up from its start
+        const ScrollbackPosition pos = m_scrollback.position();
+        m_catchUpFrom = m_lineEditing ? ScrollbackPosition{ pos.line, 0 } : pos;
+        // Edited lines restate their own attributes, other text continues the current ones
+        m_catchUpSgr = m_lineEditing ? QString() : m_activeSgr;
+    }
+    emit viewVisibleChanged(m_viewVisible);
+}
+
+void TerminalBackend::flushPendingOutput()
+{
+    // One catch-up frame built from the scrollback instead of replaying every chunk
+    const ScrollbackPosition from = m_catchUpFrom;
+    const ScrollbackPosition position = m_scrollback.position();
+    // The line being edited goes through currentLineUpdated, not newData
+    const ScrollbackPosition end = m_lineEditing ? ScrollbackPosition{ position.line, 0 } : position;
+    m_catchUpFrom = ScrollbackPosition();
+    if (from.isValid() && (from.line != end.line || from.column != end.column)) {
+        emit newData(renderScrollbackHtml(from, m_lineEditing ? end : ScrollbackPosition(), m_catchUpSgr));
+    }
+
+    for (const QString &notice : std::as_const(m_pendingNotices)) {
+        emit newData(notice);
+    }
+    m_pendingNotices.clear();
+
+    // newData drops the view's copy of the edited line, so it goes last
+    if (m_lineEditing) {
+        emit currentLineUpdated(m_currentLine.toHtml(m_colorScheme), m_currentLine.cursor());
+    }
+    m_currentLineDirty = false;
+}
+
+void TerminalBackend::trackWindow(QWindow *window)
+{
+    if (m_trackedWindow) {
+        m_trackedWindow->removeEventFilter(this);
+        disconnect(m_trackedWindow, nullptr, this, nullptr);
+    }
+    m_trackedWindow = window;
+    if (!m_trackedWindow) {
+        setViewVisible(true);
+        return;
+    }
+    m_trackedWindow->installEventFilter(this);
+    connect(m_trackedWindow, &QWindow::visibilityChanged, this, &TerminalBackend::updateViewVisibility);
+    connect(m_trackedWindow, &QObject::destroyed, this, [this] {
+        m_trackedWindow = nullptr;
+        setViewVisible(true);
+    });
+    updateViewVisibility();
+}
+
+void TerminalBackend::updateViewVisibility()
+{
+    if (!m_trackedWindow) {
+        return;
+    }
+    // isExposed() goes false when minimized, hidden, or fully occluded (where the platform reports it)
+    const QWindow::Visibility visibility = m_trackedWindow->visibility();
+    setViewVisible(m_trackedWindow->isExposed()
+                   && visibility != QWindow::Hidden
+                   && visibility != QWindow::Minimized);
+}
+
+bool TerminalBackend::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_trackedWindow) {
+        if (event->type() == QEvent::Expose) {
+            updateViewVisibility();
+        } else if (event->type() == QEvent::KeyPress && rawInputActive()) {
+            if (handleRawKey(static_cast<QKeyEvent *>(event))) {
+                return true;
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
 }
 
 // QML Interaction slots
@@ -391,6 +1120,11 @@ void TerminalBackend::sendCommand(const QString &command)
     if (m_masterFd >= 0) {
         QByteArray data = command.toUtf8() + '\n';
         ::write(m_masterFd, data.constData(), data.size());
+        // The view edits and echoes the line itself (the tty has ECHO off), so the command
+        // never comes back from the PTY; record it so the B..C range, exports and snapshots have it
+        if (!m_lineEditing && !m_passwordMode) {
+            m_scrollback.appendText(command);
+        }
     }
 
     addCommandToHistory(command);
@@ -487,6 +1221,18 @@ void TerminalBackend::paste()
     }
 
     text.replace("\r", "");
+    if (rawInputActive()) {
+        // Raw mode: the shell owns the line, so paste goes to the PTY like typed input.
+        // ESC is stripped so pasted text can't end bracketed paste early and inject keys.
+        text.remove(QChar('\x1B'));
+        text.replace('\n', '\r');
+        QByteArray data = text.toUtf8();
+        if (m_bracketedPaste) {
+            data = "\x1b[200~" + data + "\x1b[201~";
+        }
+        ::write(m_masterFd, data.constData(), data.size());
+        return;
+    }
     emit clipboardTextReady(text);
 }
 
@@ -7,16 +7,44 @@
 #include <QVariantList>
 #include <QMap>
 #include <QColor>
+#include "scrollbackbuffer.h"
+#include "sgrstate.h"
+#include "promptindex.h"
+#include "currentline.h"
+
+class QDir;
+class QWindow;
+class QKeyEvent;
+class QSocketNotifier;
+class QThread;
+class ScrollbackExporter;
 
 class TerminalBackend : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QVariantList availableColorSchemes READ availableColorSchemes NOTIFY availableColorSchemesChanged)
+    Q_PROPERTY(bool viewVisible READ viewVisible WRITE setViewVisible NOTIFY viewVisibleChanged)
+    Q_PROPERTY(bool rawInputMode READ rawInputMode WRITE setRawInputMode NOTIFY rawInputModeChanged)
 
 public:
     explicit TerminalBackend(QObject *parent = nullptr, const QString &startDir = "");
     ~TerminalBackend();
     QVariantList availableColorSchemes() const;
+    bool viewVisible() const;
+    void setViewVisible(bool visible);
+    void trackWindow(QWindow *window);
+    bool rawInputMode() const;
+    void setRawInputMode(bool enabled);
+    Q_INVOKABLE QVariantMap keyLatencyStats() const;
+
+    // format is "text", "ansi" or "html"; fileUrl may be a file:// URL or a plain path
+    Q_INVOKABLE bool saveScrollback(const QString &fileUrl, const QString &format);
+    Q_INVOKABLE void cancelScrollbackExport();
+
+    Q_INVOKABLE QString lastCommandOutput() const;
+    Q_INVOKABLE QVariantMap lastCommandInfo() const;
+    // Called when the view is cleared; drops the scrollback and the prompt index with it
+    Q_INVOKABLE void clearScrollback();
 
 public slots:
     void sendCommand(const QString &command);
@@ -30,20 +58,53 @@ public slots:
     void recallHistoryCommand(const QString &command);
     Q_INVOKABLE void recallPreviousHistory();
     Q_INVOKABLE void recallNextHistory();
+    void saveSession();
 
 signals:
     void availableColorSchemesChanged();
     void themeColorsReady(const QVariantMap &colors);
     void newData(const QString &htmlData);
+    // Raw input mode: replaces the line the cursor is on, which newData doesn't include
+    void currentLineUpdated(const QString &htmlData, int cursorColumn);
     void clipboardTextReady(const QString &text);
     void passwordModeChanged(bool active);
     void forceClear();
     void historyCommandRecalled(const QString &command);
+    void viewVisibleChanged(bool visible);
+    void commandFinished(const QVariantMap &info);
+    void rawInputModeChanged(bool enabled);
+    void processExited(int exitCode);
+    void scrollbackExportProgress(double fraction);
+    void scrollbackExportFinished(bool ok, const QString &message);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
+    void deliverHtml(const QString &html);
+    QString installShellIntegration() const;
+    void watchChild();
+    void drainOutput();
+    void reapChild();
+    bool waitForChildExit(int timeoutMs);
+    bool waitForGroupExit(pid_t group, int timeoutMs) const;
+    void setPrivateMode(const QString &params, bool enabled);
+    bool rawInputActive() const;
+    bool handleRawKey(QKeyEvent *event);
+    void restoreSession();
+    QString sessionDirectory() const;
+    void recoverOrphanedSessions(const QDir &dir) const;
+    void updateViewVisibility();
+    void flushPendingOutput();
+    QString renderScrollbackHtml(const ScrollbackPosition &from, const ScrollbackPosition &to = ScrollbackPosition(),
+                                 const QString &initialSgr = QString()) const;
     void processTerminalOutput(const QByteArray &data);
-    QString parseAnsiToHtml(const QString &text);
-    QString getColorFromScheme(int ansiCode);
+    QString parseAnsiToHtml(const QString &input);
+    void trackActiveSgr(const QString &params);
+    bool editCurrentLine(QChar finalByte, const QString &params);
+    void applyLineDiscipline();
+    bool handleShellIntegrationMark(const QString &mark);
+    QVariantMap commandInfo(const CommandRecord &record) const;
 
     // NOTE: Some ANSI SGR features (e.g., blink, alternate font, framed, encircled, etc.)
     //are not supported in Qt/QML rich text and will be ignored or simulated as best as possible.
@@ -54,22 +115,57 @@ private:
 
     int m_masterFd = -1;
     pid_t m_childPid = -1;
+    // pidfd for the child (Linux 5.3+); signals exit through the event loop
+    int m_pidFd = -1;
+    QSocketNotifier *m_exitNotifier = nullptr;
+    // Shutdown escalation: SIGHUP, wait, SIGTERM, wait, SIGKILL
+    int m_hangupTimeoutMs = 1000;
+    int m_terminateTimeoutMs = 2000;
     QString m_startDir;
     bool m_isFirstData = true;
 
     // ANSI state variables
-    QString m_foregroundColor;
-    QString m_backgroundColor;
-    bool m_isBold = false;
-    bool m_isItalic = false;
-    bool m_isUnderlined = false;
-    bool m_isDim = false;
-    bool m_isBlink = false;
-    bool m_isInverse = false;
-    bool m_isHidden = false;
-    bool m_isStrikethrough = false;
-    bool m_isDoubleUnderline = false;
-    bool m_isOverline = false;
+    SgrState m_sgr;
+
+    // Output throttling while the view is hidden or occluded.
+    // Output keeps going into m_scrollback; on re-expose everything from
+    // m_catchUpFrom is rendered as a single catch-up chunk.
+    QWindow *m_trackedWindow = nullptr;
+    bool m_viewVisible = true;
+    ScrollbackPosition m_catchUpFrom;
+    QString m_catchUpSgr;
+    QStringList m_pendingNotices;
+
+    // Everything printed by the PTY, plus the OSC 133 prompt/command index into it
+    ScrollbackBuffer m_scrollback;
+    PromptIndex m_promptIndex;
+    // Running "save scrollback" job, if any
+    QThread *m_exportThread = nullptr;
+    ScrollbackExporter *m_exporter = nullptr;
+    // Snapshot this instance took over at startup; removed once our own is saved
+    QString m_claimedSnapshotPath;
+    // Escape sequence split across two reads, completed by the next chunk
+    QString m_pendingEscape;
+    // SGR sequences since the last reset, attached to each edited cell
+    QString m_activeSgr;
+    // In raw input mode the line under the cursor is edited in place (CR, BS, CSI K, ...)
+    // and only committed to the scrollback and newData once it ends
+    CurrentLine m_currentLine;
+    bool m_lineEditing = false;
+    bool m_currentLineDirty = false;
+
+    // Raw input: keys are encoded in C++ and written straight to the PTY.
+    // Also forced on while a full-screen app has the alternate screen active.
+    bool m_rawInputMode = false;
+    bool m_alternateScreen = false;
+    bool m_applicationCursorKeys = false;
+    bool m_applicationKeypad = false;
+    bool m_bracketedPaste = false;
+    // Termios change still to re-apply once readline hands the tty to a command
+    bool m_lineDisciplinePending = false;
+    qint64 m_keyCount = 0;
+    qint64 m_keyTotalNs = 0;
+    qint64 m_keyLastNs = 0;
 
     // Password mode state
     bool m_passwordMode = false;